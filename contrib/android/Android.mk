@@ -104,6 +104,7 @@ LOCAL_SRC_FILES := \
 	src/suunto_vyper2.c \
 	src/suunto_vyper.c \
 	src/suunto_vyper_parser.c \
+	src/tcp.c \
 	src/tecdiving_divecomputereu.c \
 	src/tecdiving_divecomputereu_parser.c \
 	src/timer.c \
@@ -33,6 +33,7 @@
 #include <libdivecomputer/irda.h>
 #include <libdivecomputer/usb.h>
 #include <libdivecomputer/usbhid.h>
+#include <libdivecomputer/tcp.h>
 
 #include "common.h"
 #include "utils.h"
@@ -574,11 +575,75 @@ cleanup:
 	return status;
 }
 
+static dc_status_t
+dctool_tcp_open (dc_iostream_t **out, dc_context_t *context, const char *devname)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_iostream_t *iostream = NULL;
+	dc_tcp_protocol_t protocol = DC_TCP_RAW;
+	char hostname[256] = {0};
+	const char *p = NULL;
+
+	// Get the protocol.
+	if (strncmp (devname, "tcp://", 6) == 0) {
+		protocol = DC_TCP_RAW;
+		p = devname + 6;
+	} else {
+		protocol = DC_TCP_RFC2217;
+		p = devname + 10;
+	}
+
+	// Get the hostname. An IPv6 address is enclosed in square brackets.
+	const char *end = NULL;
+	if (*p == '[') {
+		p++;
+		end = strchr (p, ']');
+		if (end == NULL || end[1] != ':') {
+			end = NULL;
+		}
+	} else {
+		end = strrchr (p, ':');
+	}
+
+	if (end == NULL || end == p || (size_t) (end - p) >= sizeof (hostname)) {
+		ERROR ("No valid hostname specified.");
+		status = DC_STATUS_INVALIDARGS;
+		goto cleanup;
+	}
+
+	memcpy (hostname, p, end - p);
+	hostname[end - p] = 0;
+
+	// Get the port number.
+	const char *port = strrchr (end, ':') + 1;
+	char *stop = NULL;
+	unsigned long value = strtoul (port, &stop, 10);
+	if (*port == 0 || *stop != 0 || value == 0 || value > 65535) {
+		ERROR ("No valid port number specified.");
+		status = DC_STATUS_INVALIDARGS;
+		goto cleanup;
+	}
+
+	// Open the network connection.
+	status = dc_tcp_open (&iostream, context, hostname, value, protocol);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR ("Failed to open the network connection.");
+		goto cleanup;
+	}
+
+	*out = iostream;
+
+cleanup:
+	return status;
+}
+
 dc_status_t
 dctool_iostream_open (dc_iostream_t **iostream, dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t transport, const char *devname)
 {
 	switch (transport) {
 	case DC_TRANSPORT_SERIAL:
+		if (devname && (strncmp (devname, "tcp://", 6) == 0 || strncmp (devname, "rfc2217://", 10) == 0))
+			return dctool_tcp_open (iostream, context, devname);
 		return dc_serial_open (iostream, context, devname);
 	case DC_TRANSPORT_USB:
 		return dctool_usb_open(iostream, context, descriptor);
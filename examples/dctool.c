@@ -115,6 +115,8 @@ dctool_command_showhelp (const dctool_command_t *command)
 			"   -l, --logfile <logfile>   Logfile\n"
 			"   -q, --quiet               Quiet mode\n"
 			"   -v, --verbose             Verbose mode\n"
+			"   -s, --stats               Show memory usage statistics\n"
+			"   -M, --memory-limit <size> Memory limit (bytes)\n"
 #else
 			"   -h             Show help message\n"
 			"   -d <device>    Device name\n"
@@ -123,12 +125,16 @@ dctool_command_showhelp (const dctool_command_t *command)
 			"   -l <logfile>   Logfile\n"
 			"   -q             Quiet mode\n"
 			"   -v             Verbose mode\n"
+			"   -s             Show memory usage statistics\n"
+			"   -M <size>      Memory limit (bytes)\n"
 #endif
 			"\n"
 			"Available commands:\n");
 		for (size_t i = 0; g_commands[i] != NULL; ++i) {
 			printf ("   %-*s%s\n", maxlength + 3, g_commands[i]->name, g_commands[i]->description);
 		}
+		printf ("\nSerial ports behind a network bridge are available as tcp://<host>:<port> (raw)\n"
+			"or rfc2217://<host>:<port> (with port control) device names.\n");
 		printf ("\nSee 'dctool help <command>' for more information on a specific command.\n\n");
 	} else {
 		printf ("%s\n\n%s\n", command->description, command->usage);
@@ -164,6 +170,31 @@ logfunc (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsign
 	}
 }
 
+static void
+statistics (dc_context_t *context)
+{
+	const struct {
+		const char *name;
+		dc_memory_t type;
+	} subsystems[] = {
+		{"device",   DC_MEMORY_DEVICE},
+		{"parser",   DC_MEMORY_PARSER},
+		{"iostream", DC_MEMORY_IOSTREAM},
+		{"iterator", DC_MEMORY_ITERATOR},
+		{"buffer",   DC_MEMORY_BUFFER},
+		{"total",    DC_MEMORY_ALL},
+	};
+
+	message ("Memory usage (current/peak bytes):\n");
+	for (size_t i = 0; i < sizeof (subsystems) / sizeof (subsystems[0]); ++i) {
+		size_t current = 0, peak = 0;
+		if (dc_context_get_memory (context, subsystems[i].type, &current, &peak) != DC_STATUS_SUCCESS)
+			continue;
+		message ("   %-10s%lu/%lu\n", subsystems[i].name,
+			(unsigned long) current, (unsigned long) peak);
+	}
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -180,10 +211,12 @@ main (int argc, char *argv[])
 	dc_family_t family = DC_FAMILY_NULL;
 	unsigned int model = 0;
 	unsigned int have_family = 0, have_model = 0;
+	unsigned int stats = 0;
+	size_t limit = 0;
 
 	// Parse the command-line options.
 	int opt = 0;
-	const char *optstring = NOPERMUTATION "hd:f:m:l:qv";
+	const char *optstring = NOPERMUTATION "hd:f:m:l:qvsM:";
 #ifdef HAVE_GETOPT_LONG
 	struct option options[] = {
 		{"help",        no_argument,       0, 'h'},
@@ -193,6 +226,8 @@ main (int argc, char *argv[])
 		{"logfile",     required_argument, 0, 'l'},
 		{"quiet",       no_argument,       0, 'q'},
 		{"verbose",     no_argument,       0, 'v'},
+		{"stats",       no_argument,       0, 's'},
+		{"memory-limit",required_argument, 0, 'M'},
 		{0,             0,                 0,  0 }
 	};
 	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
@@ -223,6 +258,12 @@ main (int argc, char *argv[])
 		case 'v':
 			loglevel++;
 			break;
+		case 's':
+			stats = 1;
+			break;
+		case 'M':
+			limit = strtoul (optarg, NULL, 0);
+			break;
 		default:
 			return EXIT_FAILURE;
 		}
@@ -279,6 +320,9 @@ main (int argc, char *argv[])
 	dc_context_set_loglevel (context, loglevel);
 	dc_context_set_logfunc (context, logfunc, NULL);
 
+	// Setup the memory limit.
+	dc_context_set_memory_limit (context, limit);
+
 	if (device != NULL || family != DC_FAMILY_NULL) {
 		// Search for a matching device descriptor.
 		status = dctool_descriptor_search (&descriptor, device, family, model);
@@ -311,6 +355,11 @@ main (int argc, char *argv[])
 	// Execute the command.
 	exitcode = command->run (argc, argv, context, descriptor);
 
+	// Show the memory usage.
+	if (stats) {
+		statistics (context);
+	}
+
 cleanup:
 	dc_descriptor_free (descriptor);
 	dc_context_free (context);
@@ -149,21 +149,27 @@ dctool_timesync_run (int argc, char *argv[], dc_context_t *context, dc_descripto
 		goto cleanup;
 	}
 
-	// Get the system time.
-	dc_datetime_t datetime = {0};
-	dc_ticks_t now = dc_datetime_now ();
-	if (!dc_datetime_localtime(&datetime, now)) {
-		message ("ERROR: Failed to get the system time.\n");
-		exitcode = EXIT_FAILURE;
-		goto cleanup;
-	}
+	// Synchronize the clock of each device. Without a device name, the
+	// transport specific default device is used.
+	unsigned int ndevices = argc > 0 ? argc : 1;
+	for (unsigned int i = 0; i < ndevices; ++i) {
+		const char *devname = argv[i];
+
+		// Get the system time.
+		dc_datetime_t datetime = {0};
+		dc_ticks_t now = dc_datetime_now ();
+		if (!dc_datetime_localtime(&datetime, now)) {
+			message ("ERROR: Failed to get the system time.\n");
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
 
-	// Synchronize the device clock.
-	status = do_timesync (context, descriptor, transport, argv[0], &datetime);
-	if (status != DC_STATUS_SUCCESS) {
-		message ("ERROR: %s\n", dctool_errmsg (status));
-		exitcode = EXIT_FAILURE;
-		goto cleanup;
+		// Synchronize the device clock.
+		status = do_timesync (context, descriptor, transport, devname, &datetime);
+		if (status != DC_STATUS_SUCCESS) {
+			message ("ERROR: %s: %s\n", devname ? devname : "null", dctool_errmsg (status));
+			exitcode = EXIT_FAILURE;
+		}
 	}
 
 cleanup:
@@ -176,7 +182,7 @@ const dctool_command_t dctool_timesync = {
 	"timesync",
 	"Synchronize the device clock",
 	"Usage:\n"
-	"   dctool timesync [options]\n"
+	"   dctool timesync [options] [<devname>...]\n"
 	"\n"
 	"Options:\n"
 #ifdef HAVE_GETOPT_LONG
@@ -25,6 +25,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
@@ -41,11 +42,12 @@
 #include "utils.h"
 
 static dc_status_t
-dowrite (dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t transport, const char *devname, unsigned int address, dc_buffer_t *buffer)
+dowrite (dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t transport, const char *devname, unsigned int address, dc_buffer_t *buffer, unsigned int verify, unsigned int timesync)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	dc_iostream_t *iostream = NULL;
 	dc_device_t *device = NULL;
+	dc_buffer_t *readback = NULL;
 
 	// Open the I/O stream.
 	message ("Opening the I/O stream (%s, %s).\n",
@@ -92,7 +94,48 @@ dowrite (dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t tran
 		goto cleanup;
 	}
 
+	// Read the data back from the internal memory.
+	if (verify) {
+		message ("Verifying the data in the internal memory.\n");
+		readback = dc_buffer_new (dc_buffer_get_size (buffer));
+		if (readback == NULL || !dc_buffer_resize (readback, dc_buffer_get_size (buffer))) {
+			ERROR ("Error allocating the read-back buffer.");
+			rc = DC_STATUS_NOMEMORY;
+			goto cleanup;
+		}
+
+		rc = dc_device_read (device, address, dc_buffer_get_data (readback), dc_buffer_get_size (readback));
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR ("Error reading from the internal memory.");
+			goto cleanup;
+		}
+
+		if (memcmp (dc_buffer_get_data (readback), dc_buffer_get_data (buffer), dc_buffer_get_size (buffer)) != 0) {
+			ERROR ("The data in the internal memory doesn't match.");
+			rc = DC_STATUS_DATAFORMAT;
+			goto cleanup;
+		}
+	}
+
+	// Syncronize the device clock.
+	if (timesync) {
+		dc_datetime_t datetime = {0};
+		if (!dc_datetime_localtime (&datetime, dc_datetime_now ())) {
+			ERROR ("Error getting the system time.");
+			rc = DC_STATUS_IO;
+			goto cleanup;
+		}
+
+		message ("Syncronize the device clock.\n");
+		rc = dc_device_timesync (device, &datetime);
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR ("Error syncronizing the device clock.");
+			goto cleanup;
+		}
+	}
+
 cleanup:
+	dc_buffer_free (readback);
 	dc_device_close (device);
 	dc_iostream_close (iostream);
 	return rc;
@@ -111,10 +154,12 @@ dctool_write_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 	const char *filename = NULL;
 	unsigned int address = 0, have_address = 0;
 	unsigned int count = 0, have_count = 0;
+	unsigned int verify = 0;
+	unsigned int timesync = 0;
 
 	// Parse the command-line options.
 	int opt = 0;
-	const char *optstring = "ht:a:c:i:";
+	const char *optstring = "ht:a:c:i:vs";
 #ifdef HAVE_GETOPT_LONG
 	struct option options[] = {
 		{"help",        no_argument,       0, 'h'},
@@ -122,6 +167,8 @@ dctool_write_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 		{"address",     required_argument, 0, 'a'},
 		{"count",       required_argument, 0, 'c'},
 		{"input",       required_argument, 0, 'i'},
+		{"verify",      no_argument,       0, 'v'},
+		{"timesync",    no_argument,       0, 's'},
 		{0,             0,                 0,  0 }
 	};
 	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
@@ -146,6 +193,12 @@ dctool_write_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 		case 'i':
 			filename = optarg;
 			break;
+		case 'v':
+			verify = 1;
+			break;
+		case 's':
+			timesync = 1;
+			break;
 		default:
 			return EXIT_FAILURE;
 		}
@@ -190,7 +243,7 @@ dctool_write_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 	}
 
 	// Write data to the internal memory.
-	status = dowrite (context, descriptor, transport, argv[0], address, buffer);
+	status = dowrite (context, descriptor, transport, argv[0], address, buffer, verify, timesync);
 	if (status != DC_STATUS_SUCCESS) {
 		message ("ERROR: %s\n", dctool_errmsg (status));
 		exitcode = EXIT_FAILURE;
@@ -217,11 +270,15 @@ const dctool_command_t dctool_write = {
 	"   -a, --address <address>   Memory address\n"
 	"   -c, --count <count>       Number of bytes\n"
 	"   -i, --input <filename>    Input filename\n"
+	"   -v, --verify              Read back and verify the data\n"
+	"   -s, --timesync            Synchronize the device clock\n"
 #else
 	"   -h              Show help message\n"
 	"   -t <transport>  Transport type\n"
 	"   -a <address>    Memory address\n"
 	"   -c <count>      Number of bytes\n"
 	"   -i <filename>   Input filename\n"
+	"   -v              Read back and verify the data\n"
+	"   -s              Synchronize the device clock\n"
 #endif
 };
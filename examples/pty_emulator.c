@@ -0,0 +1,409 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 libdivecomputer contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+/*
+ * A scriptable dive computer emulator on a pseudo terminal. It creates a
+ * pty pair, prints the name of the slave device, and answers the requests
+ * received on the master side from a reply table. Build the library with
+ * --enable-pty, and point dctool at the slave device, e.g.
+ *
+ *   pty_emulator -d 50 -c 7 -g 20 script.txt
+ *   dctool -f <family> -d /dev/pts/N download
+ *
+ * Each line of the script contains a request and a reply, both as hex
+ * strings. Whenever the received data ends with a request, the matching
+ * reply is sent. A reply of "-" sends nothing, to emulate a timeout.
+ * Empty lines and everything after a '#' are ignored:
+ *
+ *   # request   reply
+ *   55          55
+ *   FA          -
+ *
+ * Options:
+ *   -d <ms>     Delay before sending a reply.
+ *   -c <bytes>  Send the replies in chunks of this size (partial reads).
+ *   -g <ms>     Delay between two chunks.
+ *   -e          Echo all received bytes back.
+ *
+ * The line settings applied by the application (baudrate, character size,
+ * parity and stop bits) are printed whenever they change, and so are the
+ * purge requests. On Linux, the pty driver always forces 8 data bits
+ * without parity, so only the baudrate and the stop bits are visible. The
+ * modem control lines (DTR, RTS and break) don't exist on a pseudo
+ * terminal, and can't be emulated.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+
+#define MAXRULES  256
+#define MAXPACKET 1024
+
+typedef struct rule_t {
+	unsigned char request[MAXPACKET];
+	unsigned int rsize;
+	unsigned char reply[MAXPACKET];
+	unsigned int asize;
+	int timeout;
+} rule_t;
+
+typedef struct emulator_t {
+	int master;
+	int slave;
+	rule_t rules[MAXRULES];
+	unsigned int nrules;
+	unsigned int delay;
+	unsigned int chunk;
+	unsigned int gap;
+	unsigned int echo;
+	unsigned char buffer[MAXPACKET];
+	unsigned int nbytes;
+	struct termios termios;
+} emulator_t;
+
+static void
+sleep_ms (unsigned int ms)
+{
+	if (ms)
+		usleep (ms * 1000);
+}
+
+static void
+hexdump (const char *prefix, const unsigned char data[], unsigned int size)
+{
+	printf ("%s", prefix);
+	for (unsigned int i = 0; i < size; ++i)
+		printf (" %02X", data[i]);
+	printf ("\n");
+	fflush (stdout);
+}
+
+static int
+parse_hex (const char *str, unsigned char data[], unsigned int size, unsigned int *actual)
+{
+	unsigned int n = 0;
+	size_t len = strlen (str);
+	if (len % 2 != 0 || len / 2 > size)
+		return -1;
+
+	for (size_t i = 0; i < len; i += 2) {
+		char hex[3] = {str[i], str[i + 1], 0};
+		char *end = NULL;
+		unsigned long value = strtoul (hex, &end, 16);
+		if (*end != 0)
+			return -1;
+		data[n++] = value;
+	}
+
+	*actual = n;
+
+	return 0;
+}
+
+static int
+load_script (emulator_t *emulator, const char *filename)
+{
+	FILE *fp = fopen (filename, "r");
+	if (fp == NULL) {
+		perror (filename);
+		return -1;
+	}
+
+	char line[4 * MAXPACKET];
+	unsigned int lineno = 0;
+	while (fgets (line, sizeof (line), fp)) {
+		lineno++;
+
+		// Remove the comments.
+		char *comment = strchr (line, '#');
+		if (comment)
+			*comment = 0;
+
+		char *request = strtok (line, " \t\r\n");
+		if (request == NULL)
+			continue;
+		char *reply = strtok (NULL, " \t\r\n");
+
+		if (emulator->nrules >= MAXRULES) {
+			fprintf (stderr, "%s:%u: Too many rules.\n", filename, lineno);
+			fclose (fp);
+			return -1;
+		}
+
+		rule_t *rule = emulator->rules + emulator->nrules;
+		rule->asize = 0;
+		rule->timeout = reply == NULL || strcmp (reply, "-") == 0;
+		if (parse_hex (request, rule->request, sizeof (rule->request), &rule->rsize) != 0 || rule->rsize == 0 ||
+			(!rule->timeout && parse_hex (reply, rule->reply, sizeof (rule->reply), &rule->asize) != 0)) {
+			fprintf (stderr, "%s:%u: Invalid hex string.\n", filename, lineno);
+			fclose (fp);
+			return -1;
+		}
+
+		emulator->nrules++;
+	}
+
+	fclose (fp);
+
+	return 0;
+}
+
+static unsigned int
+baudrate (speed_t speed)
+{
+	static const struct {
+		speed_t speed;
+		unsigned int baudrate;
+	} table[] = {
+		{B1200, 1200}, {B2400, 2400}, {B4800, 4800}, {B9600, 9600},
+		{B19200, 19200}, {B38400, 38400}, {B57600, 57600}, {B115200, 115200},
+	};
+
+	for (size_t i = 0; i < sizeof (table) / sizeof (table[0]); ++i) {
+		if (table[i].speed == speed)
+			return table[i].baudrate;
+	}
+
+	return 0;
+}
+
+static void
+check_settings (emulator_t *emulator)
+{
+	struct termios tty;
+	if (tcgetattr (emulator->slave, &tty) != 0)
+		return;
+
+	const tcflag_t mask = CSIZE | PARENB | PARODD | CSTOPB;
+	if (cfgetospeed (&tty) == cfgetospeed (&emulator->termios) &&
+		(tty.c_cflag & mask) == (emulator->termios.c_cflag & mask))
+		return;
+
+	emulator->termios = tty;
+
+	unsigned int databits = 8;
+	switch (tty.c_cflag & CSIZE) {
+	case CS5:
+		databits = 5;
+		break;
+	case CS6:
+		databits = 6;
+		break;
+	case CS7:
+		databits = 7;
+		break;
+	default:
+		break;
+	}
+
+	char parity = 'N';
+	if (tty.c_cflag & PARENB)
+		parity = (tty.c_cflag & PARODD) ? 'O' : 'E';
+
+	printf ("Line settings: %u %u%c%u\n", baudrate (cfgetospeed (&tty)),
+		databits, parity, (tty.c_cflag & CSTOPB) ? 2 : 1);
+	fflush (stdout);
+}
+
+static int
+send_reply (emulator_t *emulator, const unsigned char data[], unsigned int size)
+{
+	sleep_ms (emulator->delay);
+
+	unsigned int nbytes = 0;
+	while (nbytes < size) {
+		unsigned int len = size - nbytes;
+		if (emulator->chunk && len > emulator->chunk)
+			len = emulator->chunk;
+
+		if (nbytes)
+			sleep_ms (emulator->gap);
+
+		if (write (emulator->master, data + nbytes, len) != (ssize_t) len) {
+			perror ("write");
+			return -1;
+		}
+
+		nbytes += len;
+	}
+
+	hexdump (">", data, size);
+
+	return 0;
+}
+
+static int
+process (emulator_t *emulator, const unsigned char data[], unsigned int size)
+{
+	hexdump ("<", data, size);
+
+	if (emulator->echo && write (emulator->master, data, size) != (ssize_t) size) {
+		perror ("write");
+		return -1;
+	}
+
+	// Keep only the most recent data.
+	if (size > sizeof (emulator->buffer)) {
+		data += size - sizeof (emulator->buffer);
+		size = sizeof (emulator->buffer);
+	}
+	if (emulator->nbytes + size > sizeof (emulator->buffer)) {
+		unsigned int discard = emulator->nbytes + size - sizeof (emulator->buffer);
+		memmove (emulator->buffer, emulator->buffer + discard, emulator->nbytes - discard);
+		emulator->nbytes -= discard;
+	}
+	memcpy (emulator->buffer + emulator->nbytes, data, size);
+	emulator->nbytes += size;
+
+	// Find the first request that matches the end of the received data.
+	for (unsigned int i = 0; i < emulator->nrules; ++i) {
+		const rule_t *rule = emulator->rules + i;
+		if (rule->rsize > emulator->nbytes ||
+			memcmp (emulator->buffer + emulator->nbytes - rule->rsize, rule->request, rule->rsize) != 0)
+			continue;
+
+		emulator->nbytes = 0;
+
+		if (rule->timeout) {
+			printf ("> (no reply)\n");
+			fflush (stdout);
+			return 0;
+		}
+
+		return send_reply (emulator, rule->reply, rule->asize);
+	}
+
+	return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+	static emulator_t emulator;
+
+	int opt = 0;
+	while ((opt = getopt (argc, argv, "d:c:g:e")) != -1) {
+		switch (opt) {
+		case 'd':
+			emulator.delay = strtoul (optarg, NULL, 0);
+			break;
+		case 'c':
+			emulator.chunk = strtoul (optarg, NULL, 0);
+			break;
+		case 'g':
+			emulator.gap = strtoul (optarg, NULL, 0);
+			break;
+		case 'e':
+			emulator.echo = 1;
+			break;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf (stderr, "Usage: %s [-d <ms>] [-c <bytes>] [-g <ms>] [-e] <script>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (load_script (&emulator, argv[optind]) != 0)
+		return EXIT_FAILURE;
+
+	// Create the pseudo terminal pair.
+	emulator.master = posix_openpt (O_RDWR | O_NOCTTY);
+	if (emulator.master < 0 || grantpt (emulator.master) != 0 || unlockpt (emulator.master) != 0) {
+		perror ("posix_openpt");
+		return EXIT_FAILURE;
+	}
+
+	const char *name = ptsname (emulator.master);
+
+	// Keep the slave side open, such that the master doesn't report an
+	// error when the application closes the device. The slave starts in
+	// raw mode, without echoing the replies back to the emulator.
+	emulator.slave = open (name, O_RDWR | O_NOCTTY);
+	if (emulator.slave < 0 || tcgetattr (emulator.slave, &emulator.termios) != 0) {
+		perror (name);
+		return EXIT_FAILURE;
+	}
+	cfmakeraw (&emulator.termios);
+	tcsetattr (emulator.slave, TCSANOW, &emulator.termios);
+
+	// Report the purge requests of the application.
+	int on = 1;
+	ioctl (emulator.master, TIOCPKT, &on);
+
+	printf ("%s\n", name);
+	fflush (stdout);
+
+	while (1) {
+		check_settings (&emulator);
+
+		fd_set fds;
+		FD_ZERO (&fds);
+		FD_SET (emulator.master, &fds);
+
+		struct timeval tv = {0, 100000};
+		int rc = select (emulator.master + 1, &fds, NULL, NULL, &tv);
+		if (rc < 0) {
+			perror ("select");
+			break;
+		} else if (rc == 0) {
+			continue;
+		}
+
+		unsigned char packet[1 + MAXPACKET];
+		ssize_t n = read (emulator.master, packet, sizeof (packet));
+		if (n <= 0)
+			continue;
+
+		// In packet mode, the first byte indicates data or a status change.
+		if (packet[0] != TIOCPKT_DATA) {
+			if (packet[0] & TIOCPKT_FLUSHREAD)
+				printf ("Purge: input\n");
+			if (packet[0] & TIOCPKT_FLUSHWRITE)
+				printf ("Purge: output\n");
+			fflush (stdout);
+			continue;
+		}
+
+		if (n > 1 && process (&emulator, packet + 1, n - 1) != 0)
+			break;
+	}
+
+	close (emulator.slave);
+	close (emulator.master);
+
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,316 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 libdivecomputer contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+/*
+ * A minimal stand-in for an RFC 2217 serial port server. It accepts one
+ * connection at a time on the loopback interface, negotiates the telnet
+ * options, reports the COM port control commands it receives, and echoes
+ * all data bytes back to the client. Every echoed block is preceded by a
+ * telnet command, which the client has to remove from the data stream.
+ *
+ * Usage: rfc2217_loopback [<port>]
+ *
+ * The server can be used with dctool, e.g. "-d rfc2217://localhost:2217".
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define SZ_BUFFER 256
+
+// Telnet commands (RFC 854).
+#define SE   240
+#define NOP  241
+#define SB   250
+#define WILL 251
+#define WONT 252
+#define DO   253
+#define DONT 254
+#define IAC  255
+
+// Telnet options.
+#define OPT_BINARY  0
+#define OPT_SGA     3
+#define OPT_COMPORT 44
+
+// The server replies to a COM port control command with the same
+// command number plus this offset (RFC 2217).
+#define SERVER_OFFSET 100
+
+typedef enum state_t {
+	STATE_DATA,
+	STATE_IAC,
+	STATE_OPTION,
+	STATE_SB,
+	STATE_SB_IAC,
+} state_t;
+
+typedef struct session_t {
+	int fd;
+	state_t state;
+	unsigned int command;
+	unsigned char sb[16];
+	unsigned int nsb;
+} session_t;
+
+static int
+session_write (session_t *session, const unsigned char data[], size_t size)
+{
+	size_t nbytes = 0;
+	while (nbytes < size) {
+		ssize_t n = write (session->fd, data + nbytes, size - nbytes);
+		if (n <= 0)
+			return -1;
+		nbytes += n;
+	}
+
+	return 0;
+}
+
+static void
+session_option (session_t *session, unsigned int command, unsigned int option)
+{
+	const char *names[] = {"WILL", "WONT", "DO", "DONT"};
+	unsigned int reply = 0;
+
+	printf ("< IAC %s %u\n", names[command - WILL], option);
+
+	// Accept the options of a transparent 8-bit data path with COM port
+	// control, and refuse all others. Replies to the options requested
+	// by the server are not answered again.
+	int supported = option == OPT_BINARY || option == OPT_SGA || option == OPT_COMPORT;
+	switch (command) {
+	case WILL:
+		if (option == OPT_COMPORT)
+			return;
+		reply = supported ? DO : DONT;
+		break;
+	case DO:
+		if (option == OPT_COMPORT)
+			reply = WONT;
+		else
+			reply = supported ? WILL : WONT;
+		break;
+	default:
+		return;
+	}
+
+	const unsigned char data[] = {IAC, reply, option};
+	session_write (session, data, sizeof (data));
+}
+
+static void
+session_comport (session_t *session)
+{
+	if (session->nsb < 2 || session->sb[0] != OPT_COMPORT)
+		return;
+
+	unsigned int command = session->sb[1];
+	const unsigned char *value = session->sb + 2;
+	unsigned int size = session->nsb - 2;
+
+	printf ("< COM-PORT-OPTION %u:", command);
+	for (unsigned int i = 0; i < size; ++i)
+		printf (" %02x", value[i]);
+	printf ("\n");
+
+	// Acknowledge the command, by returning the requested value.
+	unsigned char data[4 + 2 * 4 + 2];
+	unsigned int n = 0;
+	data[n++] = IAC;
+	data[n++] = SB;
+	data[n++] = OPT_COMPORT;
+	data[n++] = command + SERVER_OFFSET;
+	for (unsigned int i = 0; i < size && i < 4; ++i) {
+		if (value[i] == IAC)
+			data[n++] = IAC;
+		data[n++] = value[i];
+	}
+	data[n++] = IAC;
+	data[n++] = SE;
+	session_write (session, data, n);
+}
+
+/*
+ * Remove the telnet commands from the received data, and process them.
+ * Returns the number of data bytes, which are moved to the start of the
+ * buffer.
+ */
+static size_t
+session_filter (session_t *session, unsigned char data[], size_t size)
+{
+	size_t n = 0;
+
+	for (size_t i = 0; i < size; ++i) {
+		unsigned char c = data[i];
+		switch (session->state) {
+		case STATE_DATA:
+			if (c == IAC) {
+				session->state = STATE_IAC;
+			} else {
+				data[n++] = c;
+			}
+			break;
+		case STATE_IAC:
+			if (c == IAC) {
+				data[n++] = c;
+				session->state = STATE_DATA;
+			} else if (c >= WILL) {
+				session->command = c;
+				session->state = STATE_OPTION;
+			} else if (c == SB) {
+				session->nsb = 0;
+				session->state = STATE_SB;
+			} else {
+				session->state = STATE_DATA;
+			}
+			break;
+		case STATE_OPTION:
+			session_option (session, session->command, c);
+			session->state = STATE_DATA;
+			break;
+		case STATE_SB:
+			if (c == IAC) {
+				session->state = STATE_SB_IAC;
+			} else if (session->nsb < sizeof (session->sb)) {
+				session->sb[session->nsb++] = c;
+			}
+			break;
+		case STATE_SB_IAC:
+			if (c == SE) {
+				session_comport (session);
+				session->state = STATE_DATA;
+			} else {
+				if (c == IAC && session->nsb < sizeof (session->sb))
+					session->sb[session->nsb++] = c;
+				session->state = STATE_SB;
+			}
+			break;
+		}
+	}
+
+	return n;
+}
+
+static void
+session_run (int fd)
+{
+	session_t session = {fd, STATE_DATA, 0, {0}, 0};
+
+	// Request a transparent 8-bit data path, and the COM port control
+	// option from the client.
+	static const unsigned char negotiate[] = {
+		IAC, WILL, OPT_BINARY,
+		IAC, DO, OPT_BINARY,
+		IAC, WILL, OPT_SGA,
+		IAC, DO, OPT_SGA,
+		IAC, DO, OPT_COMPORT,
+	};
+	if (session_write (&session, negotiate, sizeof (negotiate)) != 0)
+		return;
+
+	while (1) {
+		unsigned char buffer[SZ_BUFFER];
+		ssize_t len = read (fd, buffer, sizeof (buffer));
+		if (len <= 0)
+			break;
+
+		size_t n = session_filter (&session, buffer, len);
+		if (n == 0)
+			continue;
+
+		printf ("< %u data bytes\n", (unsigned int) n);
+
+		// Echo the data bytes, preceded by a telnet command, and with the
+		// IAC bytes escaped.
+		unsigned char echo[2 + 2 * SZ_BUFFER];
+		size_t m = 0;
+		echo[m++] = IAC;
+		echo[m++] = NOP;
+		for (size_t i = 0; i < n; ++i) {
+			if (buffer[i] == IAC)
+				echo[m++] = IAC;
+			echo[m++] = buffer[i];
+		}
+
+		if (session_write (&session, echo, m) != 0)
+			break;
+	}
+}
+
+int
+main (int argc, char *argv[])
+{
+	unsigned int port = 2217;
+	if (argc > 1)
+		port = strtoul (argv[1], NULL, 0);
+
+	int fd = socket (AF_INET, SOCK_STREAM, 0);
+	if (fd < 0) {
+		perror ("socket");
+		return EXIT_FAILURE;
+	}
+
+	int optval = 1;
+	setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof (optval));
+
+	struct sockaddr_in addr;
+	memset (&addr, 0, sizeof (addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons (port);
+	addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+	if (bind (fd, (struct sockaddr *) &addr, sizeof (addr)) != 0 ||
+		listen (fd, 1) != 0) {
+		perror ("bind");
+		close (fd);
+		return EXIT_FAILURE;
+	}
+
+	printf ("Listening on 127.0.0.1:%u\n", port);
+
+	while (1) {
+		int client = accept (fd, NULL, NULL);
+		if (client < 0) {
+			perror ("accept");
+			break;
+		}
+
+		printf ("Connected\n");
+		session_run (client);
+		printf ("Disconnected\n");
+
+		close (client);
+	}
+
+	close (fd);
+
+	return EXIT_SUCCESS;
+}
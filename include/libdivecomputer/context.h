@@ -22,6 +22,8 @@
 #ifndef DC_CONTEXT_H
 #define DC_CONTEXT_H
 
+#include <stddef.h>
+
 #include "common.h"
 
 #ifdef __cplusplus
@@ -39,6 +41,15 @@ typedef enum dc_loglevel_t {
 	DC_LOGLEVEL_ALL
 } dc_loglevel_t;
 
+typedef enum dc_memory_t {
+	DC_MEMORY_ALL,
+	DC_MEMORY_DEVICE,
+	DC_MEMORY_PARSER,
+	DC_MEMORY_IOSTREAM,
+	DC_MEMORY_ITERATOR,
+	DC_MEMORY_BUFFER
+} dc_memory_t;
+
 typedef void (*dc_logfunc_t) (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *message, void *userdata);
 
 dc_status_t
@@ -56,6 +67,12 @@ dc_context_set_logfunc (dc_context_t *context, dc_logfunc_t logfunc, void *userd
 unsigned int
 dc_context_get_transports (dc_context_t *context);
 
+dc_status_t
+dc_context_set_memory_limit (dc_context_t *context, size_t limit);
+
+dc_status_t
+dc_context_get_memory (dc_context_t *context, dc_memory_t type, size_t *current, size_t *peak);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -24,6 +24,7 @@
 
 #include "common.h"
 #include "device.h"
+#include "parser.h"
 #include "datetime.h"
 #include "buffer.h"
 
@@ -58,6 +59,9 @@ hw_ostc_device_screenshot (dc_device_t *device, dc_buffer_t *buffer, hw_ostc_for
 dc_status_t
 hw_ostc_device_fwupdate (dc_device_t *abstract, const char *filename);
 
+dc_status_t
+hw_ostc_parser_set_cache (dc_parser_t *parser, size_t limit);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
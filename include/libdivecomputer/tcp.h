@@ -0,0 +1,64 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 libdivecomputer contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_TCP_H
+#define DC_TCP_H
+
+#include "common.h"
+#include "context.h"
+#include "iostream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * The protocol used by the network serial bridge.
+ */
+typedef enum dc_tcp_protocol_t {
+	DC_TCP_RAW,     /**< Raw TCP (serial settings are ignored) */
+	DC_TCP_RFC2217  /**< Telnet with the RFC 2217 COM port control option */
+} dc_tcp_protocol_t;
+
+/**
+ * Open a connection to a serial port behind a network serial bridge.
+ *
+ * The connection behaves as a serial port. With the RFC 2217 protocol,
+ * the line settings, the DTR and RTS lines, the break condition and
+ * purging are forwarded to the remote serial port. With the raw
+ * protocol, the remote serial port must already be configured correctly
+ * and those requests are silently ignored.
+ *
+ * @param[out]  iostream A location to store the connection.
+ * @param[in]   context  A valid context object.
+ * @param[in]   hostname The hostname or IP address of the bridge.
+ * @param[in]   port     The TCP port number.
+ * @param[in]   protocol The protocol of the bridge.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_tcp_open (dc_iostream_t **iostream, dc_context_t *context, const char *hostname, unsigned int port, dc_tcp_protocol_t protocol);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_TCP_H */
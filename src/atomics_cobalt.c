@@ -40,18 +40,20 @@
 #define TIMEOUT 2000
 
 #define FP_OFFSET 20
+#define FP_SIZE   6
 
 #define SZ_HEADER 228
 
 #define SZ_MEMORY1 (29 * 64 * 1024) // Cobalt 1
 #define SZ_MEMORY2 (41 * 64 * 1024) // Cobalt 2
 #define SZ_VERSION 14
+#define SZ_PACKET  (8 * 1024)
 
 typedef struct atomics_cobalt_device_t {
 	dc_device_t base;
 	dc_iostream_t *iostream;
 	unsigned int simulation;
-	unsigned char fingerprint[6];
+	unsigned char fingerprint[FP_SIZE];
 	unsigned char version[SZ_VERSION];
 } atomics_cobalt_device_t;
 
@@ -198,7 +200,7 @@ atomics_cobalt_device_version (dc_device_t *abstract, unsigned char data[], unsi
 
 
 static dc_status_t
-atomics_cobalt_read_dive (dc_device_t *abstract, dc_buffer_t *buffer, int init, dc_event_progress_t *progress)
+atomics_cobalt_read_dive (dc_device_t *abstract, dc_buffer_t *buffer, int init, const unsigned char fingerprint[], dc_event_progress_t *progress)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	atomics_cobalt_device_t *device = (atomics_cobalt_device_t *) abstract;
@@ -243,11 +245,22 @@ atomics_cobalt_read_dive (dc_device_t *abstract, dc_buffer_t *buffer, int init,
 	}
 
 	unsigned int nbytes = 0;
+	unsigned int total = 0;
+	unsigned int skip = 0;
+	unsigned short sum = 0;
+	unsigned char tail[2] = {0};
 	while (1) {
-		// Receive the answer from the dive computer.
+		// Reserve space for the next packet.
+		if (!dc_buffer_resize (buffer, nbytes + SZ_PACKET)) {
+			ERROR (abstract->context, "Insufficient buffer space available.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		// Receive the answer from the dive computer, directly into the
+		// output buffer.
 		size_t length = 0;
-		unsigned char packet[8 * 1024] = {0};
-		status = dc_iostream_read (device->iostream, packet, sizeof(packet), &length);
+		unsigned char *packet = dc_buffer_get_data (buffer) + nbytes;
+		status = dc_iostream_read (device->iostream, packet, SZ_PACKET, &length);
 		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_TIMEOUT) {
 			ERROR (abstract->context, "Failed to receive the answer.");
 			return status;
@@ -259,21 +272,57 @@ atomics_cobalt_read_dive (dc_device_t *abstract, dc_buffer_t *buffer, int init,
 			device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 		}
 
-		// Append the packet to the output buffer.
-		dc_buffer_append (buffer, packet, length);
-		nbytes += length;
+		// Keep a running checksum and the last two bytes of the transfer,
+		// such that the checksum can also be verified for the data that
+		// is drained without being stored.
+		sum = checksum_add_uint16 (packet, length, sum);
+		if (length >= 2) {
+			tail[0] = packet[length - 2];
+			tail[1] = packet[length - 1];
+		} else if (length == 1) {
+			tail[0] = tail[1];
+			tail[1] = packet[0];
+		}
+		total += length;
+
+		// Once the dive header is available, compare the fingerprint. If
+		// the dive is already downloaded, the remainder of the transfer
+		// only needs to be drained, and is not stored.
+		if (!skip) {
+			nbytes += length;
+			if (fingerprint && nbytes >= SZ_HEADER &&
+				memcmp (dc_buffer_get_data (buffer) + FP_OFFSET, fingerprint, FP_SIZE) == 0) {
+				skip = 1;
+			}
+		}
 
 		// If we received fewer bytes than requested, the transfer is finished.
-		if (length < sizeof (packet))
+		if (length < SZ_PACKET)
 			break;
 	}
 
-	// Check for a buffer error.
-	if (dc_buffer_get_size (buffer) != nbytes) {
-		ERROR (abstract->context, "Insufficient buffer space available.");
-		return DC_STATUS_NOMEMORY;
+	// Return only the dive header if the fingerprint was found, but
+	// only after the checksum of the entire transfer has been verified.
+	if (skip) {
+		if (total < SZ_HEADER + 2) {
+			ERROR (abstract->context, "Data packet is too short.");
+			return DC_STATUS_PROTOCOL;
+		}
+
+		unsigned short crc = array_uint16_le (tail);
+		unsigned short ccrc = sum - tail[0] - tail[1];
+		if (crc != ccrc) {
+			ERROR (abstract->context, "Unexpected answer checksum.");
+			return DC_STATUS_PROTOCOL;
+		}
+
+		dc_buffer_slice (buffer, 0, SZ_HEADER);
+		return DC_STATUS_SUCCESS;
 	}
 
+	// Remove the unused space.
+	dc_buffer_slice (buffer, 0, nbytes);
+
 	// Check for the minimum length.
 	if (nbytes < 2) {
 		ERROR (abstract->context, "Data packet is too short.");
@@ -340,7 +389,7 @@ atomics_cobalt_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 
 	unsigned int ndives = 0;
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	while ((rc = atomics_cobalt_read_dive (abstract, buffer, (ndives == 0), &progress)) == DC_STATUS_SUCCESS) {
+	while ((rc = atomics_cobalt_read_dive (abstract, buffer, (ndives == 0), device->fingerprint, &progress)) == DC_STATUS_SUCCESS) {
 		unsigned char *data = dc_buffer_get_data (buffer);
 		unsigned int size = dc_buffer_get_size (buffer);
 
@@ -64,6 +64,12 @@ dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file,
 dc_status_t
 dc_context_syserror (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, int errcode);
 
+dc_status_t
+dc_context_memory_add (dc_context_t *context, dc_memory_t type, size_t size);
+
+void
+dc_context_memory_remove (dc_context_t *context, dc_memory_t type, size_t size);
+
 dc_status_t
 dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *prefix, const unsigned char data[], unsigned int size);
 
@@ -38,10 +38,19 @@
 #include "platform.h"
 #include "timer.h"
 
+#define NMEMORY (DC_MEMORY_BUFFER + 1)
+
+typedef struct dc_memory_usage_t {
+	size_t current;
+	size_t peak;
+} dc_memory_usage_t;
+
 struct dc_context_t {
 	dc_loglevel_t loglevel;
 	dc_logfunc_t logfunc;
 	void *userdata;
+	dc_memory_usage_t memory[NMEMORY];
+	size_t limit;
 #ifdef ENABLE_LOGGING
 	char msg[16384 + 32];
 	dc_timer_t *timer;
@@ -124,6 +133,8 @@ dc_context_new (dc_context_t **out)
 	context->logfunc = NULL;
 #endif
 	context->userdata = NULL;
+	memset (context->memory, 0, sizeof (context->memory));
+	context->limit = 0;
 
 #ifdef ENABLE_LOGGING
 	memset (context->msg, 0, sizeof (context->msg));
@@ -273,6 +284,70 @@ dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *f
 	return DC_STATUS_SUCCESS;
 }
 
+dc_status_t
+dc_context_set_memory_limit (dc_context_t *context, size_t limit)
+{
+	if (context == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	context->limit = limit;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_context_get_memory (dc_context_t *context, dc_memory_t type, size_t *current, size_t *peak)
+{
+	if (context == NULL || (unsigned int) type >= NMEMORY)
+		return DC_STATUS_INVALIDARGS;
+
+	if (current)
+		*current = context->memory[type].current;
+
+	if (peak)
+		*peak = context->memory[type].peak;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static void
+dc_memory_usage_add (dc_memory_usage_t *usage, size_t size)
+{
+	usage->current += size;
+	if (usage->peak < usage->current)
+		usage->peak = usage->current;
+}
+
+dc_status_t
+dc_context_memory_add (dc_context_t *context, dc_memory_t type, size_t size)
+{
+	if (context == NULL || type == DC_MEMORY_ALL)
+		return DC_STATUS_SUCCESS;
+
+	// Check the memory limit.
+	size_t current = context->memory[DC_MEMORY_ALL].current;
+	if (context->limit && (size > context->limit || current > context->limit - size)) {
+		ERROR (context, "Memory limit exceeded (" DC_PRINTF_SIZE " + " DC_PRINTF_SIZE " > " DC_PRINTF_SIZE " bytes).",
+			current, size, context->limit);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	dc_memory_usage_add (context->memory + type, size);
+	dc_memory_usage_add (context->memory + DC_MEMORY_ALL, size);
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_context_memory_remove (dc_context_t *context, dc_memory_t type, size_t size)
+{
+	if (context == NULL || type == DC_MEMORY_ALL)
+		return;
+
+	context->memory[type].current -= size;
+	context->memory[DC_MEMORY_ALL].current -= size;
+}
+
 unsigned int
 dc_context_get_transports (dc_context_t *context)
 {
@@ -29,6 +29,7 @@
 #include "checksum.h"
 #include "array.h"
 #include "platform.h"
+#include "timer.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &cressi_goa_device_vtable)
 
@@ -45,6 +46,8 @@
 #define SZ_PACKET 10
 #define SZ_HEADER 23
 
+#define DELAY     100
+
 #define FP_OFFSET 0x11
 #define FP_SIZE   6
 
@@ -54,11 +57,14 @@
 typedef struct cressi_goa_device_t {
 	dc_device_t base;
 	dc_iostream_t *iostream;
+	dc_timer_t *timer;
+	dc_usecs_t timestamp;
 	unsigned char fingerprint[FP_SIZE];
 } cressi_goa_device_t;
 
 static dc_status_t cressi_goa_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
 static dc_status_t cressi_goa_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata);
+static dc_status_t cressi_goa_device_close (dc_device_t *abstract);
 
 static const dc_device_vtable_t cressi_goa_device_vtable = {
 	sizeof(cressi_goa_device_t),
@@ -69,9 +75,34 @@ static const dc_device_vtable_t cressi_goa_device_vtable = {
 	NULL, /* dump */
 	cressi_goa_device_foreach, /* foreach */
 	NULL, /* timesync */
-	NULL /* close */
+	cressi_goa_device_close /* close */
 };
 
+static void
+cressi_goa_device_timestamp (cressi_goa_device_t *device)
+{
+	// Remember the time of the last activity on the line.
+	dc_timer_now (device->timer, &device->timestamp);
+}
+
+static void
+cressi_goa_device_delay (cressi_goa_device_t *device)
+{
+	// Get the time elapsed since the last activity.
+	dc_usecs_t now = 0;
+	if (dc_timer_now (device->timer, &now) != DC_STATUS_SUCCESS) {
+		now = device->timestamp;
+	}
+
+	dc_usecs_t elapsed = now - device->timestamp;
+	dc_usecs_t expected = (dc_usecs_t) DELAY * 1000;
+
+	// Wait for the remaining time only.
+	if (elapsed < expected) {
+		dc_iostream_sleep (device->iostream, (expected - elapsed + 999) / 1000);
+	}
+}
+
 static dc_status_t
 cressi_goa_device_send (cressi_goa_device_t *device, unsigned char cmd, const unsigned char data[], unsigned int size)
 {
@@ -99,8 +130,10 @@ cressi_goa_device_send (cressi_goa_device_t *device, unsigned char cmd, const un
 	packet[5 + size + 2] = TRAILER;
 
 	// Wait a small amount of time before sending the command. Without
-	// this delay, the transfer will fail most of the time.
-	dc_iostream_sleep (device->iostream, 100);
+	// this delay, the transfer will fail most of the time. Time that
+	// already passed since the previous transfer (e.g. while the
+	// application processed the previous dive) counts towards the delay.
+	cressi_goa_device_delay (device);
 
 	// Send the command to the device.
 	status = dc_iostream_write (device->iostream, packet, size + 8, NULL);
@@ -171,6 +204,8 @@ cressi_goa_device_receive (cressi_goa_device_t *device, unsigned char data[], un
 		memcpy (data, packet + 5, length);
 	}
 
+	cressi_goa_device_timestamp (device);
+
 	return status;
 }
 
@@ -264,6 +299,8 @@ cressi_goa_device_download (cressi_goa_device_t *device, dc_buffer_t *buffer, dc
 		return status;
 	}
 
+	cressi_goa_device_timestamp (device);
+
 	return status;
 }
 
@@ -319,48 +356,70 @@ cressi_goa_device_open (dc_device_t **out, dc_context_t *context, dc_iostream_t
 
 	// Set the default values.
 	device->iostream = iostream;
+	device->timestamp = 0;
 	memset (device->fingerprint, 0, sizeof (device->fingerprint));
 
+	// Create a high resolution timer.
+	status = dc_timer_new (&device->timer);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to create a high resolution timer.");
+		goto error_free;
+	}
+
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_iostream_configure (device->iostream, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the terminal attributes.");
-		goto error_free;
+		goto error_timer_free;
 	}
 
 	// Set the timeout for receiving data (3000 ms).
 	status = dc_iostream_set_timeout (device->iostream, 3000);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the timeout.");
-		goto error_free;
+		goto error_timer_free;
 	}
 
 	// Clear the RTS line.
 	status = dc_iostream_set_rts (device->iostream, 0);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to clear the RTS line.");
-		goto error_free;
+		goto error_timer_free;
 	}
 
 	// Clear the DTR line.
 	status = dc_iostream_set_dtr (device->iostream, 0);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to clear the DTR line.");
-		goto error_free;
+		goto error_timer_free;
 	}
 
-	dc_iostream_sleep (device->iostream, 100);
+	cressi_goa_device_timestamp (device);
+
+	dc_iostream_sleep (device->iostream, DELAY);
 	dc_iostream_purge (device->iostream, DC_DIRECTION_ALL);
 
 	*out = (dc_device_t *) device;
 
 	return DC_STATUS_SUCCESS;
 
+error_timer_free:
+	dc_timer_free (device->timer);
 error_free:
 	dc_device_deallocate ((dc_device_t *) device);
 	return status;
 }
 
+static dc_status_t
+cressi_goa_device_close (dc_device_t *abstract)
+{
+	cressi_goa_device_t *device = (cressi_goa_device_t *) abstract;
+
+	dc_timer_free (device->timer);
+
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 cressi_goa_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size)
 {
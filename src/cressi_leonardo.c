@@ -45,11 +45,13 @@
 
 #define MAXRETRIES 4
 #define PACKETSIZE 32
+#define PACKETSIZE_MAX 256
 
 typedef struct cressi_leonardo_device_t {
 	dc_device_t base;
 	dc_iostream_t *iostream;
 	unsigned char fingerprint[5];
+	unsigned int packetsize;
 } cressi_leonardo_device_t;
 
 static dc_status_t cressi_leonardo_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
@@ -95,7 +97,7 @@ cressi_leonardo_make_ascii (const unsigned char raw[], unsigned int rsize, unsig
 }
 
 static dc_status_t
-cressi_leonardo_packet (cressi_leonardo_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize)
+cressi_leonardo_packet (cressi_leonardo_device_t *device, const unsigned char command[], unsigned int csize, unsigned char answer[], unsigned int asize, unsigned int probe)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
@@ -111,15 +113,24 @@ cressi_leonardo_packet (cressi_leonardo_device_t *device, const unsigned char co
 	}
 
 	// Receive the answer of the device.
+	// A failed probe is an expected outcome, and is handled by the caller.
 	status = dc_iostream_read (device->iostream, answer, asize, NULL);
 	if (status != DC_STATUS_SUCCESS) {
-		ERROR (abstract->context, "Failed to receive the answer.");
+		if (probe) {
+			DEBUG (abstract->context, "Failed to receive the answer.");
+		} else {
+			ERROR (abstract->context, "Failed to receive the answer.");
+		}
 		return status;
 	}
 
 	// Verify the header and trailer of the packet.
 	if (answer[0] != '{' || answer[asize - 1] != '}') {
-		ERROR (abstract->context, "Unexpected answer header/trailer byte.");
+		if (probe) {
+			DEBUG (abstract->context, "Unexpected answer header/trailer byte.");
+		} else {
+			ERROR (abstract->context, "Unexpected answer header/trailer byte.");
+		}
 		return DC_STATUS_PROTOCOL;
 	}
 
@@ -131,7 +142,11 @@ cressi_leonardo_packet (cressi_leonardo_device_t *device, const unsigned char co
 	unsigned short crc = array_uint16_be (checksum);
 	unsigned short ccrc = checksum_crc16_ccitt (answer + 1, asize - 6, 0xffff, 0x0000);
 	if (crc != ccrc) {
-		ERROR (abstract->context, "Unexpected answer checksum.");
+		if (probe) {
+			DEBUG (abstract->context, "Unexpected answer checksum.");
+		} else {
+			ERROR (abstract->context, "Unexpected answer checksum.");
+		}
 		return DC_STATUS_PROTOCOL;
 	}
 
@@ -143,7 +158,7 @@ cressi_leonardo_transfer (cressi_leonardo_device_t *device, const unsigned char
 {
 	unsigned int nretries = 0;
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	while ((rc = cressi_leonardo_packet (device, command, csize, answer, asize)) != DC_STATUS_SUCCESS) {
+	while ((rc = cressi_leonardo_packet (device, command, csize, answer, asize, 0)) != DC_STATUS_SUCCESS) {
 		// Automatically discard a corrupted packet,
 		// and request a new one.
 		if (rc != DC_STATUS_PROTOCOL && rc != DC_STATUS_TIMEOUT)
@@ -180,6 +195,7 @@ cressi_leonardo_device_open (dc_device_t **out, dc_context_t *context, dc_iostre
 	// Set the default values.
 	device->iostream = iostream;
 	memset (device->fingerprint, 0, sizeof (device->fingerprint));
+	device->packetsize = PACKETSIZE_MAX;
 
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_iostream_configure (device->iostream, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
@@ -256,8 +272,8 @@ cressi_leonardo_device_read (dc_device_t *abstract, unsigned int address, unsign
 	while (nbytes < size) {
 		// Calculate the packet size.
 		unsigned int len = size - nbytes;
-		if (len > PACKETSIZE)
-			len = PACKETSIZE;
+		if (len > device->packetsize)
+			len = device->packetsize;
 
 		// Build the raw command.
 		unsigned char raw[] = {
@@ -271,8 +287,29 @@ cressi_leonardo_device_read (dc_device_t *abstract, unsigned int address, unsign
 		cressi_leonardo_make_ascii (raw, sizeof (raw), command, sizeof (command));
 
 		// Send the command and receive the answer.
-		unsigned char answer[2 * (PACKETSIZE + 3)] = {0};
-		rc = cressi_leonardo_transfer (device, command, sizeof (command), answer, 2 * (len + 3));
+		unsigned char answer[2 * (PACKETSIZE_MAX + 3)] = {0};
+		if (len > PACKETSIZE) {
+			// Not all firmware versions support packets larger than the
+			// default packet size. Probe the larger packet size without
+			// retries, and on failure fall back to a smaller packet size
+			// for this and all subsequent requests. The new size is based
+			// on the failed length, because a short final packet should
+			// not be probed again at the same length.
+			rc = cressi_leonardo_packet (device, command, sizeof (command), answer, 2 * (len + 3), 1);
+			if (rc == DC_STATUS_PROTOCOL || rc == DC_STATUS_TIMEOUT) {
+				device->packetsize = len / 2;
+				if (device->packetsize < PACKETSIZE)
+					device->packetsize = PACKETSIZE;
+				WARNING (abstract->context, "Falling back to a packet size of %u bytes.", device->packetsize);
+
+				// Discard any garbage bytes.
+				dc_iostream_sleep (device->iostream, 100);
+				dc_iostream_purge (device->iostream, DC_DIRECTION_INPUT);
+				continue;
+			}
+		} else {
+			rc = cressi_leonardo_transfer (device, command, sizeof (command), answer, 2 * (len + 3));
+		}
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
 
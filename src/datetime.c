@@ -23,6 +23,7 @@
 #include "config.h"
 #endif
 
+#include <limits.h>
 #include <time.h>
 
 #include <libdivecomputer/datetime.h>
@@ -44,62 +45,105 @@ dc_localtime_r (const time_t *t, struct tm *tm)
 #endif
 }
 
-static struct tm *
-dc_gmtime_r (const time_t *t, struct tm *tm)
+#define SECONDS_PER_DAY (24 * 60 * 60)
+#define DAYS_PER_ERA    146097 /* 400 years */
+
+/*
+ * Number of days since 1970-01-01 in the proleptic Gregorian calendar.
+ *
+ * The year is shifted to start in March, such that the leap day is the
+ * last day of the year, and the day of the year can be calculated with
+ * a simple linear formula.
+ */
+static dc_ticks_t
+dc_days_from_civil (dc_ticks_t year, unsigned int month, unsigned int day)
 {
-#ifdef HAVE_GMTIME_R
-	return gmtime_r (t, tm);
-#else
-	struct tm *p = gmtime (t);
-	if (p == NULL)
-		return NULL;
+	if (month <= 2)
+		year--;
 
-	if (tm)
-		*tm = *p;
+	dc_ticks_t era = (year >= 0 ? year : year - 399) / 400;
+	unsigned int yoe = year - era * 400;
+	unsigned int doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	unsigned int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
 
-	return tm;
-#endif
+	return era * DAYS_PER_ERA + doe - 719468;
+}
+
+/*
+ * Inverse of dc_days_from_civil.
+ */
+static void
+dc_civil_from_days (dc_ticks_t days, dc_ticks_t *year, unsigned int *month, unsigned int *day)
+{
+	days += 719468;
+
+	dc_ticks_t era = (days >= 0 ? days : days - (DAYS_PER_ERA - 1)) / DAYS_PER_ERA;
+	unsigned int doe = days - era * DAYS_PER_ERA;
+	unsigned int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	unsigned int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	unsigned int mp = (5 * doy + 2) / 153;
+	unsigned int m = mp < 10 ? mp + 3 : mp - 9;
+
+	*year = yoe + era * 400 + (m <= 2);
+	*month = m;
+	*day = doy - (153 * mp + 2) / 5 + 1;
 }
 
-static time_t
-dc_timegm (struct tm *tm)
+/*
+ * Convert a timestamp to a broken down time with a fixed offset (in
+ * seconds) from UTC. This is a purely arithmetic conversion, without any
+ * calls into the C library.
+ */
+static dc_datetime_t *
+dc_datetime_from_ticks (dc_datetime_t *result, dc_ticks_t ticks, int offset)
 {
-#if defined(HAVE_TIMEGM)
-	return timegm (tm);
-#elif defined (HAVE__MKGMTIME)
-	return _mkgmtime (tm);
-#else
-	static const unsigned int mdays[] = {
-		0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
-	};
-
-	if (tm == NULL ||
-		tm->tm_mon  < 0 || tm->tm_mon  > 11 ||
-		tm->tm_mday < 1 || tm->tm_mday > 31 ||
-		tm->tm_hour < 0 || tm->tm_hour > 23 ||
-		tm->tm_min  < 0 || tm->tm_min  > 59 ||
-		tm->tm_sec  < 0 || tm->tm_sec  > 60)
-		return (time_t) -1;
-
-	/* Number of leap days since 1970-01-01. */
-	int year = tm->tm_year + 1900 - (tm->tm_mon < 2);
-	int leapdays =
-		((year / 4) - (year / 100) + (year / 400)) -
-		((1969 / 4) - (1969 / 100) + (1969 / 400));
-
-	time_t result = 0;
-	result += (tm->tm_year - 70) * 365;
-	result += leapdays;
-	result += mdays[tm->tm_mon];
-	result += tm->tm_mday - 1;
-	result *= 24;
-	result += tm->tm_hour;
-	result *= 60;
-	result += tm->tm_min;
-	result *= 60;
-	result += tm->tm_sec;
+	ticks += offset;
+
+	dc_ticks_t days = ticks / SECONDS_PER_DAY;
+	dc_ticks_t seconds = ticks % SECONDS_PER_DAY;
+	if (seconds < 0) {
+		seconds += SECONDS_PER_DAY;
+		days--;
+	}
+
+	dc_ticks_t year = 0;
+	unsigned int month = 0, day = 0;
+	dc_civil_from_days (days, &year, &month, &day);
+	if (year < INT_MIN || year > INT_MAX)
+		return NULL;
+
+	if (result) {
+		result->year = year;
+		result->month = month;
+		result->day = day;
+		result->hour = seconds / 3600;
+		result->minute = (seconds % 3600) / 60;
+		result->second = seconds % 60;
+		result->timezone = offset;
+	}
+
 	return result;
-#endif
+}
+
+/*
+ * Convert a broken down time to a timestamp, ignoring the timezone. Out
+ * of range values are normalized, like timegm() does.
+ */
+static dc_ticks_t
+dc_datetime_to_ticks (const dc_datetime_t *dt)
+{
+	// Normalize the month to the range 1-12.
+	dc_ticks_t year = dt->year;
+	dc_ticks_t month = (dc_ticks_t) dt->month - 1;
+	year += (month >= 0 ? month : month - 11) / 12;
+	month -= ((month >= 0 ? month : month - 11) / 12) * 12;
+
+	dc_ticks_t days = dc_days_from_civil (year, month + 1, 1) + dt->day - 1;
+
+	return days * SECONDS_PER_DAY +
+		(dc_ticks_t) dt->hour * 3600 +
+		(dc_ticks_t) dt->minute * 60 +
+		dt->second;
 }
 
 dc_ticks_t
@@ -115,6 +159,9 @@ dc_datetime_localtime (dc_datetime_t *result,
 	time_t t = ticks;
 	int offset = 0;
 
+	// Only the UTC offset is needed from the C library, because it depends
+	// on the timezone database. The conversion itself is done with the
+	// arithmetic code path.
 	struct tm tm;
 	if (dc_localtime_r (&t, &tm) == NULL)
 		return NULL;
@@ -122,48 +169,26 @@ dc_datetime_localtime (dc_datetime_t *result,
 #ifdef HAVE_STRUCT_TM_TM_GMTOFF
 	offset = tm.tm_gmtoff;
 #else
-	struct tm tmp = tm;
-	time_t t_local = dc_timegm (&tmp);
-	if (t_local == (time_t) -1)
-		return NULL;
-
-	offset = t_local - t;
+	dc_datetime_t local;
+	local.year = tm.tm_year + 1900;
+	local.month = tm.tm_mon + 1;
+	local.day = tm.tm_mday;
+	local.hour = tm.tm_hour;
+	local.minute = tm.tm_min;
+	local.second = tm.tm_sec;
+	local.timezone = DC_TIMEZONE_NONE;
+
+	offset = dc_datetime_to_ticks (&local) - ticks;
 #endif
 
-	if (result) {
-		result->year = tm.tm_year + 1900;
-		result->month = tm.tm_mon + 1;
-		result->day = tm.tm_mday;
-		result->hour = tm.tm_hour;
-		result->minute = tm.tm_min;
-		result->second = tm.tm_sec;
-		result->timezone = offset;
-	}
-
-	return result;
+	return dc_datetime_from_ticks (result, ticks, offset);
 }
 
 dc_datetime_t *
 dc_datetime_gmtime (dc_datetime_t *result,
                     dc_ticks_t ticks)
 {
-	time_t t = ticks;
-
-	struct tm tm;
-	if (dc_gmtime_r (&t, &tm) == NULL)
-		return NULL;
-
-	if (result) {
-		result->year = tm.tm_year + 1900;
-		result->month = tm.tm_mon + 1;
-		result->day = tm.tm_mday;
-		result->hour = tm.tm_hour;
-		result->minute = tm.tm_min;
-		result->second = tm.tm_sec;
-		result->timezone = 0;
-	}
-
-	return result;
+	return dc_datetime_from_ticks (result, ticks, 0);
 }
 
 dc_ticks_t
@@ -172,22 +197,11 @@ dc_datetime_mktime (const dc_datetime_t *dt)
 	if (dt == NULL)
 		return -1;
 
-	struct tm tm;
-	tm.tm_year = dt->year - 1900;
-	tm.tm_mon = dt->month - 1;
-	tm.tm_mday = dt->day;
-	tm.tm_hour = dt->hour;
-	tm.tm_min = dt->minute;
-	tm.tm_sec = dt->second;
-	tm.tm_isdst = 0;
-
-	time_t t = dc_timegm (&tm);
-	if (t == (time_t) -1)
-		return t;
+	dc_ticks_t ticks = dc_datetime_to_ticks (dt);
 
 	if (dt->timezone != DC_TIMEZONE_NONE) {
-		t -= dt->timezone;
+		ticks -= dt->timezone;
 	}
 
-	return t;
+	return ticks;
 }
@@ -44,6 +44,8 @@
 // stack buffers.
 #define MAX_DATA 20
 
+#define SZ_PACKET (1 + 2 * (3 + MAX_DATA) + 1)
+
 #define SZ_HEADER 36
 
 #define FP_OFFSET   6
@@ -67,6 +69,9 @@ typedef struct deepblu_cosmiq_device_t {
 	dc_device_t base;
 	dc_iostream_t *iostream;
 	unsigned char fingerprint[FP_SIZE];
+	unsigned char cache[SZ_PACKET];
+	size_t available;
+	size_t offset;
 } deepblu_cosmiq_device_t;
 
 static dc_status_t deepblu_cosmiq_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
@@ -120,7 +125,7 @@ deepblu_cosmiq_send (deepblu_cosmiq_device_t *device, const unsigned char cmd, c
 	if (size) {
 		memcpy (raw + 3, data, size);
 	}
-	unsigned char packet[1 + 2 * (3 + MAX_DATA) + 1] = {0};
+	unsigned char packet[SZ_PACKET] = {0};
 	packet[0] = '#';
 	array_convert_bin2hex (raw, 3 + size, packet + 1, 2 * (3 + size));
 	packet[1 + 2 * (3 + size)] = '\n';
@@ -145,7 +150,8 @@ deepblu_cosmiq_send (deepblu_cosmiq_device_t *device, const unsigned char cmd, c
 // Semi BLE chip will sometimes send packets early (some internal
 // serial buffer timeout?) with incompete data.
 //
-// So read packets until you get newline.
+// So read packets until you get newline. Any data received after the
+// newline is kept in the cache, and consumed by the next call.
 static dc_status_t
 deepblu_cosmiq_recv_line (deepblu_cosmiq_device_t *device, unsigned char data[], size_t size, size_t *actual)
 {
@@ -153,34 +159,47 @@ deepblu_cosmiq_recv_line (deepblu_cosmiq_device_t *device, unsigned char data[],
 	size_t nbytes = 0;
 
 	while (1) {
-		unsigned char buffer[20] = {0};
-		size_t transferred = 0;
+		// Refill the cache.
+		if (device->available == 0) {
+			size_t transferred = 0;
+
+			status = dc_iostream_read (device->iostream, device->cache, sizeof(device->cache), &transferred);
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR (device->base.context, "Failed to receive the reply packet.");
+				return status;
+			}
 
-		status = dc_iostream_read (device->iostream, buffer, sizeof(buffer), &transferred);
-		if (status != DC_STATUS_SUCCESS) {
-			ERROR (device->base.context, "Failed to receive the reply packet.");
-			return status;
-		}
+			if (transferred < 1) {
+				ERROR (device->base.context, "Empty reply packet received.");
+				return DC_STATUS_PROTOCOL;
+			}
 
-		if (transferred < 1) {
-			ERROR (device->base.context, "Empty reply packet received.");
-			return DC_STATUS_PROTOCOL;
+			device->offset = 0;
+			device->available = transferred;
 		}
 
+		// Locate the end of the line.
+		const unsigned char *p = device->cache + device->offset;
+		const unsigned char *eol = memchr (p, '\n', device->available);
+		size_t n = eol ? (size_t) (eol - p) + 1 : device->available;
+
 		// Append the payload data to the output buffer. If the output
 		// buffer is too small, the error is not reported immediately
-		// but delayed until all packets have been received.
+		// but delayed until the end of the line has been received.
 		if (nbytes < size) {
-			size_t n = transferred;
-			if (nbytes + n > size) {
-				n = size - nbytes;
+			size_t len = n;
+			if (nbytes + len > size) {
+				len = size - nbytes;
 			}
-			memcpy(data + nbytes, buffer, n);
+			memcpy(data + nbytes, p, len);
 		}
-		nbytes += transferred;
+		nbytes += n;
+
+		device->offset += n;
+		device->available -= n;
 
 		// Last packet?
-		if (buffer[transferred - 1] == '\n')
+		if (eol)
 			break;
 	}
 
@@ -205,7 +224,7 @@ static dc_status_t
 deepblu_cosmiq_recv (deepblu_cosmiq_device_t *device, const unsigned char cmd, unsigned char data[], size_t size, size_t *actual)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
-	unsigned char packet[1 + 2 * (3 + MAX_DATA) + 1] = {0};
+	unsigned char packet[SZ_PACKET] = {0};
 
 	size_t transferred = 0;
 	status = deepblu_cosmiq_recv_line (device, packet, sizeof(packet), &transferred);
@@ -222,44 +241,46 @@ deepblu_cosmiq_recv (deepblu_cosmiq_device_t *device, const unsigned char cmd, u
 		return DC_STATUS_PROTOCOL;
 	}
 
-	size_t length = transferred - 2;
-
-	unsigned char raw[3 + MAX_DATA] = {0};
-	if (array_convert_hex2bin (packet + 1, length, raw, length / 2) != 0) {
+	// Decode the header.
+	unsigned char header[3] = {0};
+	if (array_convert_hex2bin (packet + 1, 2 * sizeof(header), header, sizeof(header)) != 0) {
 		ERROR (device->base.context, "Unexpected packet data.");
 		return DC_STATUS_PROTOCOL;
 	}
 
-	length /= 2;
-
-	HEXDUMP (device->base.context, DC_LOGLEVEL_DEBUG, "rcv", raw, length);
+	HEXDUMP (device->base.context, DC_LOGLEVEL_DEBUG, "rcv", header, sizeof(header));
 
-	unsigned char rsp = raw[0];
+	unsigned char rsp = header[0];
 	if (rsp != cmd) {
 		ERROR (device->base.context, "Unexpected packet command byte (%02x)", rsp);
 		return DC_STATUS_PROTOCOL;
 	}
 
-	unsigned int n = raw[2];
+	unsigned int n = header[2];
 	if ((n % 2) != 0 || n != transferred - 8) {
 		ERROR (device->base.context, "Unexpected packet length (%u)", n);
 		return DC_STATUS_PROTOCOL;
 	}
 
-	unsigned char csum = checksum_add_uint8 (raw, length, 0);
-	if (csum != 0) {
-		ERROR (device->base.context, "Unexpected packet checksum (%02x).", csum);
+	size_t length = n / 2;
+	if (length > size) {
+		ERROR (device->base.context, "Unexpected number of bytes received (" DC_PRINTF_SIZE " " DC_PRINTF_SIZE ").", length, size);
 		return DC_STATUS_PROTOCOL;
 	}
 
-	length -= 3;
-
-	if (length > size) {
-		ERROR (device->base.context, "Unexpected number of bytes received (" DC_PRINTF_SIZE " " DC_PRINTF_SIZE ").", length, size);
+	// Decode the payload directly into the output buffer.
+	if (array_convert_hex2bin (packet + 1 + 2 * sizeof(header), n, data, length) != 0) {
+		ERROR (device->base.context, "Unexpected packet data.");
 		return DC_STATUS_PROTOCOL;
 	}
 
-	memcpy (data, raw + 3, length);
+	HEXDUMP (device->base.context, DC_LOGLEVEL_DEBUG, "data", data, length);
+
+	unsigned char csum = checksum_add_uint8 (data, length, checksum_add_uint8 (header, sizeof(header), 0));
+	if (csum != 0) {
+		ERROR (device->base.context, "Unexpected packet checksum (%02x).", csum);
+		return DC_STATUS_PROTOCOL;
+	}
 
 	if (actual)
 		*actual = length;
@@ -337,6 +358,8 @@ deepblu_cosmiq_device_open (dc_device_t **out, dc_context_t *context, dc_iostrea
 	// Set the default values.
 	device->iostream = iostream;
 	memset (device->fingerprint, 0, sizeof(device->fingerprint));
+	device->available = 0;
+	device->offset = 0;
 
 	// Set the timeout for receiving data (1000ms).
 	status = dc_iostream_set_timeout (device->iostream, 1000);
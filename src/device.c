@@ -81,10 +81,15 @@ dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
 	assert(vtable != NULL);
 	assert(vtable->size >= sizeof(dc_device_t));
 
+	// Check the memory limit.
+	if (dc_context_memory_add (context, DC_MEMORY_DEVICE, vtable->size) != DC_STATUS_SUCCESS)
+		return NULL;
+
 	// Allocate memory.
 	device = (dc_device_t *) malloc (vtable->size);
 	if (device == NULL) {
 		ERROR (context, "Failed to allocate memory.");
+		dc_context_memory_remove (context, DC_MEMORY_DEVICE, vtable->size);
 		return device;
 	}
 
@@ -108,6 +113,11 @@ dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
 void
 dc_device_deallocate (dc_device_t *device)
 {
+	if (device == NULL)
+		return;
+
+	dc_context_memory_remove (device->context, DC_MEMORY_DEVICE, device->vtable->size);
+
 	free (device);
 }
 
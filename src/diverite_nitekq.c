@@ -236,64 +236,58 @@ diverite_nitekq_device_set_fingerprint (dc_device_t *abstract, const unsigned ch
 
 
 static dc_status_t
-diverite_nitekq_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
+diverite_nitekq_device_download (diverite_nitekq_device_t *device, dc_buffer_t *buffer, unsigned int nblocks, dc_event_progress_t *progress)
 {
-	diverite_nitekq_device_t *device = (diverite_nitekq_device_t*) abstract;
+	dc_device_t *abstract = (dc_device_t *) device;
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	unsigned char packet[256] = {0};
 
-	// Pre-allocate the required amount of memory.
-	if (!dc_buffer_reserve (buffer, SZ_PACKET + SZ_MEMORY)) {
-		ERROR (abstract->context, "Insufficient buffer space available.");
-		return DC_STATUS_NOMEMORY;
-	}
-
-	// Enable progress notifications.
-	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
-	progress.maximum = SZ_PACKET + SZ_MEMORY;
-	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
-
-	// Emit a vendor event.
-	dc_event_vendor_t vendor;
-	vendor.data = device->version;
-	vendor.size = sizeof (device->version);
-	device_event_emit (abstract, DC_EVENT_VENDOR, &vendor);
-
-	// Emit a device info event.
-	dc_event_devinfo_t devinfo;
-	devinfo.model = 0;
-	devinfo.firmware = 0;
-	devinfo.serial = array_uint32_be (device->version + 0x0A);
-	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
-
-	// Send the upload request. It's not clear whether this request is
-	// actually needed, but let's send it anyway.
-	rc = diverite_nitekq_send (device, UPLOAD);
-	if (rc != DC_STATUS_SUCCESS) {
-		return rc;
-	}
+	if (dc_buffer_get_size (buffer) == 0) {
+		// Emit a vendor event.
+		dc_event_vendor_t vendor;
+		vendor.data = device->version;
+		vendor.size = sizeof (device->version);
+		device_event_emit (abstract, DC_EVENT_VENDOR, &vendor);
+
+		// Emit a device info event.
+		dc_event_devinfo_t devinfo;
+		devinfo.model = 0;
+		devinfo.firmware = 0;
+		devinfo.serial = array_uint32_be (device->version + 0x0A);
+		device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
+
+		// Send the upload request. It's not clear whether this request is
+		// actually needed, but let's send it anyway.
+		rc = diverite_nitekq_send (device, UPLOAD);
+		if (rc != DC_STATUS_SUCCESS) {
+			return rc;
+		}
 
-	// Receive the response packet. It's currently not used (or needed)
-	// for anything, but we prepend it to the main data anyway, in case
-	// we ever need it in the future.
-	rc = diverite_nitekq_receive (device, packet, sizeof (packet));
-	if (rc != DC_STATUS_SUCCESS) {
-		return rc;
-	}
+		// Receive the response packet. It's currently not used (or needed)
+		// for anything, but we prepend it to the main data anyway, in case
+		// we ever need it in the future.
+		rc = diverite_nitekq_receive (device, packet, sizeof (packet));
+		if (rc != DC_STATUS_SUCCESS) {
+			return rc;
+		}
 
-	dc_buffer_append (buffer, packet, sizeof (packet));
+		dc_buffer_append (buffer, packet, sizeof (packet));
 
-	// Update and emit a progress event.
-	progress.current += SZ_PACKET;
-	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+		// Update and emit a progress event.
+		progress->current += SZ_PACKET;
+		device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 
-	// Send the request to initiate downloading memory blocks.
-	rc = diverite_nitekq_send (device, RESET);
-	if (rc != DC_STATUS_SUCCESS) {
-		return rc;
+		// Send the request to initiate downloading memory blocks.
+		rc = diverite_nitekq_send (device, RESET);
+		if (rc != DC_STATUS_SUCCESS) {
+			return rc;
+		}
 	}
 
-	for (unsigned int i = 0; i < 128; ++i) {
+	// The memory blocks can only be downloaded sequentially. Continue
+	// with the first block that has not been downloaded yet.
+	unsigned int first = dc_buffer_get_size (buffer) / SZ_PACKET - 1;
+	for (unsigned int i = first; i < nblocks; ++i) {
 		// Request the next memory block.
 		rc = diverite_nitekq_send (device, BLOCK);
 		if (rc != DC_STATUS_SUCCESS) {
@@ -309,31 +303,123 @@ diverite_nitekq_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 		dc_buffer_append (buffer, packet, sizeof (packet));
 
 		// Update and emit a progress event.
-		progress.current += SZ_PACKET;
-		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+		progress->current += SZ_PACKET;
+		device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 	}
 
 	return DC_STATUS_SUCCESS;
 }
 
 
+static dc_status_t
+diverite_nitekq_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
+{
+	diverite_nitekq_device_t *device = (diverite_nitekq_device_t*) abstract;
+
+	// Pre-allocate the required amount of memory.
+	if (!dc_buffer_clear (buffer) || !dc_buffer_reserve (buffer, SZ_PACKET + SZ_MEMORY)) {
+		ERROR (abstract->context, "Insufficient buffer space available.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Enable progress notifications.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = SZ_PACKET + SZ_MEMORY;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	return diverite_nitekq_device_download (device, buffer, SZ_MEMORY / SZ_PACKET, &progress);
+}
+
+
 static dc_status_t
 diverite_nitekq_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
-	dc_buffer_t *buffer = dc_buffer_new (0);
-	if (buffer == NULL)
+	diverite_nitekq_device_t *device = (diverite_nitekq_device_t*) abstract;
+
+	dc_status_t rc = dc_context_memory_add (abstract->context, DC_MEMORY_BUFFER, SZ_PACKET + SZ_MEMORY);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	dc_buffer_t *buffer = dc_buffer_new (SZ_PACKET + SZ_MEMORY);
+	if (buffer == NULL) {
+		dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, SZ_PACKET + SZ_MEMORY);
 		return DC_STATUS_NOMEMORY;
+	}
 
-	dc_status_t rc = diverite_nitekq_device_dump (abstract, buffer);
+	// Enable progress notifications.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = SZ_PACKET + SZ_MEMORY;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Download the memory blocks with the logbook entries, the profile
+	// addresses and the end of profile pointer.
+	unsigned int nblocks = (EOP + 2 + SZ_PACKET - 1) / SZ_PACKET;
+	rc = diverite_nitekq_device_download (device, buffer, nblocks, &progress);
 	if (rc != DC_STATUS_SUCCESS) {
 		dc_buffer_free (buffer);
+		dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, SZ_PACKET + SZ_MEMORY);
 		return rc;
 	}
 
+	const unsigned char *data = dc_buffer_get_data (buffer) + SZ_PACKET;
+
+	// Find the oldest profile address that is needed to download the
+	// new dives. Because the profile data can only be downloaded
+	// sequentially, the download can stop after the block containing
+	// the end of the most recent dive, unless the new profile data
+	// wraps around the end of the ringbuffer.
+	unsigned int eop = array_uint16_be (data + EOP);
+	unsigned int wrap = 0;
+	unsigned int previous = eop;
+	for (unsigned int i = 0; i < 10; ++i) {
+		const unsigned char *p = data + LOGBOOK + i * SZ_LOGBOOK;
+		if (array_isequal (p, SZ_LOGBOOK, 0x00))
+			break;
+
+		if (memcmp (p, device->fingerprint, sizeof (device->fingerprint)) == 0)
+			break;
+
+		unsigned int address = array_uint16_be (data + ADDRESS + i * 2);
+		if (previous <= address) {
+			wrap = 1;
+			break;
+		}
+
+		previous = address;
+	}
+
+	// Invalid pointers are reported when the dives are extracted.
+	if (wrap || eop < RB_PROFILE_BEGIN || eop >= RB_PROFILE_END) {
+		nblocks = SZ_MEMORY / SZ_PACKET;
+	} else if (previous != eop) {
+		nblocks = (eop + SZ_PACKET - 1) / SZ_PACKET;
+	}
+
+	// Update and emit a progress event.
+	progress.maximum = SZ_PACKET + nblocks * SZ_PACKET;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Download the remaining memory blocks.
+	rc = diverite_nitekq_device_download (device, buffer, nblocks, &progress);
+	if (rc != DC_STATUS_SUCCESS) {
+		dc_buffer_free (buffer);
+		dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, SZ_PACKET + SZ_MEMORY);
+		return rc;
+	}
+
+	// The memory blocks that were not downloaded are not needed, and are
+	// filled with zeros.
+	if (!dc_buffer_resize (buffer, SZ_PACKET + SZ_MEMORY)) {
+		dc_buffer_free (buffer);
+		dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, SZ_PACKET + SZ_MEMORY);
+		return DC_STATUS_NOMEMORY;
+	}
+
 	rc = diverite_nitekq_extract_dives (abstract,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), callback, userdata);
 
 	dc_buffer_free (buffer);
+	dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, SZ_PACKET + SZ_MEMORY);
 
 	return rc;
 }
@@ -358,9 +444,14 @@ diverite_nitekq_extract_dives (dc_device_t *abstract, const unsigned char data[]
 	data += SZ_PACKET;
 
 	// Allocate memory.
-	unsigned char *buffer = (unsigned char *) malloc (SZ_LOGBOOK + RB_PROFILE_END - RB_PROFILE_BEGIN);
+	unsigned int capacity = SZ_LOGBOOK + RB_PROFILE_END - RB_PROFILE_BEGIN;
+	dc_status_t rc = dc_context_memory_add (context, DC_MEMORY_BUFFER, capacity);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+	unsigned char *buffer = (unsigned char *) malloc (capacity);
 	if (buffer == NULL) {
 		ERROR (context, "Failed to allocate memory.");
+		dc_context_memory_remove (context, DC_MEMORY_BUFFER, capacity);
 		return DC_STATUS_NOMEMORY;
 	}
 
@@ -369,6 +460,7 @@ diverite_nitekq_extract_dives (dc_device_t *abstract, const unsigned char data[]
 	if (eop < RB_PROFILE_BEGIN || eop >= RB_PROFILE_END) {
 		ERROR (context, "Invalid ringbuffer pointer detected (0x%04x).", eop);
 		free (buffer);
+		dc_context_memory_remove (context, DC_MEMORY_BUFFER, capacity);
 		return DC_STATUS_DATAFORMAT;
 	}
 
@@ -390,6 +482,7 @@ diverite_nitekq_extract_dives (dc_device_t *abstract, const unsigned char data[]
 		if (address < RB_PROFILE_BEGIN || address >= RB_PROFILE_END) {
 			ERROR (context, "Invalid ringbuffer pointer detected (0x%04x).", address);
 			free (buffer);
+			dc_context_memory_remove (context, DC_MEMORY_BUFFER, capacity);
 			return DC_STATUS_DATAFORMAT;
 		}
 
@@ -421,6 +514,7 @@ diverite_nitekq_extract_dives (dc_device_t *abstract, const unsigned char data[]
 	}
 
 	free (buffer);
+	dc_context_memory_remove (context, DC_MEMORY_BUFFER, capacity);
 
 	return DC_STATUS_SUCCESS;
 }
@@ -72,6 +72,7 @@ typedef struct divesoft_freedom_device_t {
 	dc_iostream_t *iostream;
 	unsigned char fingerprint[FINGERPRINT_SIZE];
 	unsigned int seqnum;
+	dc_buffer_t *buffer;
 } divesoft_freedom_device_t;
 
 static dc_status_t divesoft_freedom_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
@@ -253,40 +254,32 @@ divesoft_freedom_download (divesoft_freedom_device_t *device, message_t cmd, con
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
 
-	dc_buffer_t *buffer = dc_buffer_new (rsize);
-	if (buffer == NULL) {
-		ERROR (abstract->context, "Failed to allocate memory.");
-		status = DC_STATUS_NOMEMORY;
-		goto error_exit;
-	}
+	// Re-use the receive buffer of the device.
+	dc_buffer_t *buffer = device->buffer;
+	dc_buffer_clear (buffer);
 
 	message_t msg = MSG_ECHO;
 	status = divesoft_freedom_transfer (device, NULL, cmd, cdata, csize, &msg, buffer);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to transfer the packet.");
-		goto error_free;
+		return status;
 	}
 
 	if (msg != cmd + 1) {
 		ERROR (abstract->context, "Unexpected response message (%u).", msg);
-		status = DC_STATUS_PROTOCOL;
-		goto error_free;
+		return DC_STATUS_PROTOCOL;
 	}
 
 	size_t length = dc_buffer_get_size (buffer);
 	if (length != rsize) {
 		ERROR (abstract->context, "Unexpected response length (" DC_PRINTF_SIZE " " DC_PRINTF_SIZE ").", length, rsize);
-		status =  DC_STATUS_PROTOCOL;
-		goto error_free;
+		return DC_STATUS_PROTOCOL;
 	}
 
 	if (rsize) {
 		memcpy (rdata, dc_buffer_get_data (buffer), rsize);
 	}
 
-error_free:
-	dc_buffer_free (buffer);
-error_exit:
 	return status;
 }
 
@@ -310,12 +303,21 @@ divesoft_freedom_device_open (dc_device_t **out, dc_context_t *context, dc_iostr
 	device->iostream = NULL;
 	memset(device->fingerprint, 0, sizeof(device->fingerprint));
 	device->seqnum = 0;
+	device->buffer = NULL;
+
+	// Allocate the receive buffer.
+	device->buffer = dc_buffer_new (NRECORDS * (4 + FINGERPRINT_SIZE + HEADER_SIZE_V2));
+	if (device->buffer == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
 
 	// Setup the HDLC communication.
 	status = dc_hdlc_open (&device->iostream, context, iostream, 244, 244);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to create the HDLC stream.");
-		goto error_free;
+		goto error_free_buffer;
 	}
 
 	// Set the serial communication protocol (115200 8N1).
@@ -355,6 +357,8 @@ divesoft_freedom_device_open (dc_device_t **out, dc_context_t *context, dc_iostr
 
 error_free_hdlc:
 	dc_iostream_close (device->iostream);
+error_free_buffer:
+	dc_buffer_free (device->buffer);
 error_free:
 	dc_device_deallocate ((dc_device_t *) device);
 	return status;
@@ -365,6 +369,8 @@ divesoft_freedom_device_close (dc_device_t *abstract)
 {
 	divesoft_freedom_device_t *device = (divesoft_freedom_device_t *) abstract;
 
+	dc_buffer_free (device->buffer);
+
 	return dc_iostream_close (device->iostream);
 }
 
@@ -417,32 +423,27 @@ divesoft_freedom_device_foreach (dc_device_t *abstract, dc_dive_callback_t callb
 	device_event_emit(abstract, DC_EVENT_DEVINFO, &devinfo);
 
 	// Allocate memory for the dive list.
-	dc_buffer_t *divelist = dc_buffer_new (0);
+	dc_buffer_t *divelist = dc_buffer_new (NRECORDS * (4 + FINGERPRINT_SIZE + HEADER_SIZE_V2));
 	if (divelist == NULL) {
 		status = DC_STATUS_NOMEMORY;
 		goto error_exit;
 	}
 
-	// Allocate memory for the download buffer.
-	dc_buffer_t *buffer = dc_buffer_new (NRECORDS * (4 + FINGERPRINT_SIZE + HEADER_SIZE_V2));
-	if (buffer == NULL) {
-		status = DC_STATUS_NOMEMORY;
-		goto error_free_divelist;
-	}
+	// Use the receive buffer of the device for the dives.
+	dc_buffer_t *buffer = device->buffer;
 
 	// Record version and size.
 	unsigned int version = 0;
 	unsigned int headersize = 0;
 	unsigned int recordsize = 0;
 
-	// Download the dive list.
-	unsigned int ndives = 0;
-	unsigned int total = 0;
-	unsigned int maxsize = 0;
+	// Download the dive list, one block of records at a time. The dives
+	// of each block are downloaded, and passed to the application,
+	// before the next block is requested.
 	unsigned int current = INVALID;
 	while (1) {
 		// Clear the buffer.
-		dc_buffer_clear (buffer);
+		dc_buffer_clear (divelist);
 
 		// Prepare the command.
 		unsigned char cmd_list[6] = {0};
@@ -450,19 +451,26 @@ divesoft_freedom_device_foreach (dc_device_t *abstract, dc_dive_callback_t callb
 		cmd_list[4] = DIRECTION;
 		cmd_list[5] = NRECORDS;
 
+		// Reserve room for the next block of the dive list. The size of
+		// the first block is unknown until the record version is known.
+		if (recordsize) {
+			progress.maximum += NRECORDS * recordsize;
+			device_event_emit(abstract, DC_EVENT_PROGRESS, &progress);
+		}
+
 		// Download the dive list records.
 		message_t msg_list = MSG_ECHO;
-		status = divesoft_freedom_transfer (device, &progress, MSG_DIVE_LIST, cmd_list, sizeof(cmd_list), &msg_list, buffer);
+		status = divesoft_freedom_transfer (device, &progress, MSG_DIVE_LIST, cmd_list, sizeof(cmd_list), &msg_list, divelist);
 		if (status != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to download the dive list.");
-			goto error_free_buffer;
+			goto error_free_divelist;
 		}
 
 		// Check the response message type.
 		if (msg_list != MSG_DIVE_LIST_V1 && msg_list != MSG_DIVE_LIST_V2) {
 			ERROR (abstract->context, "Unexpected response message (%u).", msg_list);
 			status = DC_STATUS_PROTOCOL;
-			goto error_free_buffer;
+			goto error_free_divelist;
 		}
 
 		// Store/check the version.
@@ -474,22 +482,24 @@ divesoft_freedom_device_foreach (dc_device_t *abstract, dc_dive_callback_t callb
 		} else if (version != msg_list) {
 			ERROR (abstract->context, "Unexpected response message (%u).", msg_list);
 			status = DC_STATUS_PROTOCOL;
-			goto error_free_buffer;
+			goto error_free_divelist;
 		}
 
-		const unsigned char *data = dc_buffer_get_data (buffer);
-		size_t size = dc_buffer_get_size (buffer);
+		const unsigned char *data = dc_buffer_get_data (divelist);
+		size_t size = dc_buffer_get_size (divelist);
 
-		// Process the records.
+		// Locate the fingerprint, and calculate the total size of the
+		// new dives in this block.
 		size_t offset = 0, count = 0;
+		unsigned int total = 0;
+		int found = 0;
 		while (offset + recordsize <= size) {
-			// Get the record data.
-			unsigned int handle = array_uint32_le (data + offset);
 			const unsigned char *fingerprint = data + offset + 4;
 			const unsigned char *header = data + offset + 4 + FINGERPRINT_SIZE;
 
 			// Check the fingerprint data.
 			if (memcmp (device->fingerprint, fingerprint, sizeof(device->fingerprint)) == 0) {
+				found = 1;
 				break;
 			}
 
@@ -497,97 +507,77 @@ divesoft_freedom_device_foreach (dc_device_t *abstract, dc_dive_callback_t callb
 			unsigned int nrecords = version == MSG_DIVE_LIST_V1 ?
 				array_uint32_le (header + 16) & 0x3FFFF :
 				array_uint32_le (header + 20);
-			unsigned int length = headersize + nrecords * RECORD_SIZE;
-
-			// Calculate the total and maximum size.
-			if (length > maxsize)
-				maxsize = length;
-			total += length;
-
-			// Set the handle for the next request.
-			current = handle;
+			total += headersize + nrecords * RECORD_SIZE;
 
 			offset += recordsize;
 			count++;
-			ndives++;
 		}
 
-		// Append the records to the dive list buffer.
-		if (!dc_buffer_append (divelist, data, count * recordsize)) {
-			ERROR (abstract->context, "Insufficient buffer space available.");
-			status = DC_STATUS_NOMEMORY;
-			goto error_free_buffer;
-		}
+		// Update and emit a progress event. The list block has been
+		// received, so only the new dives remain.
+		progress.maximum = progress.current + total;
+		device_event_emit(abstract, DC_EVENT_PROGRESS, &progress);
 
-		// Stop downloading if there are no more records.
-		if (count < NRECORDS)
-			break;
-	}
-
-	// Update and emit a progress event.
-	progress.maximum = progress.current + total;
-	device_event_emit(abstract, DC_EVENT_PROGRESS, &progress);
-
-	// Reserve memory for the largest dive.
-	dc_buffer_reserve (buffer, maxsize);
-
-	const unsigned char *data = dc_buffer_get_data (divelist);
-	size_t size = dc_buffer_get_size (divelist);
+		for (size_t i = 0; i < count; ++i) {
+			// Get the record data.
+			const unsigned char *record = data + i * recordsize;
+			unsigned int handle = array_uint32_le (record);
+			const unsigned char *fingerprint = record + 4;
+			const unsigned char *header = record + 4 + FINGERPRINT_SIZE;
 
-	size_t offset = 0;
-	while (offset + recordsize <= size) {
-		// Get the record data.
-		unsigned int handle = array_uint32_le (data + offset);
-		const unsigned char *fingerprint = data + offset + 4;
-		const unsigned char *header = data + offset + 4 + FINGERPRINT_SIZE;
+			// Get the length of the dive.
+			unsigned int nrecords = version == MSG_DIVE_LIST_V1 ?
+				array_uint32_le (header + 16) & 0x3FFFF :
+				array_uint32_le (header + 20);
+			unsigned int length = headersize + nrecords * RECORD_SIZE;
 
-		// Get the length of the dive.
-		unsigned int nrecords = version == MSG_DIVE_LIST_V1 ?
-			array_uint32_le (header + 16) & 0x3FFFF :
-			array_uint32_le (header + 20);
-		unsigned int length = headersize + nrecords * RECORD_SIZE;
+			// Clear the buffer and reserve memory for the dive.
+			dc_buffer_clear (buffer);
+			dc_buffer_reserve (buffer, length);
+
+			// Prepare the command.
+			unsigned char cmd_dive[12] = {0};
+			array_uint32_le_set (cmd_dive + 0, handle);
+			array_uint32_le_set (cmd_dive + 4, 0);
+			array_uint32_le_set (cmd_dive + 8, length);
+
+			// Download the dive.
+			message_t msg_dive = MSG_ECHO;
+			status = divesoft_freedom_transfer (device, &progress, MSG_DIVE_DATA, cmd_dive, sizeof(cmd_dive), &msg_dive, buffer);
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR (abstract->context, "Failed to download the dive.");
+				goto error_free_divelist;
+			}
 
-		// Clear the buffer.
-		dc_buffer_clear (buffer);
+			// Check the response message type.
+			if (msg_dive != MSG_DIVE_DATA_RSP) {
+				ERROR (abstract->context, "Unexpected response message (%u).", msg_dive);
+				status = DC_STATUS_PROTOCOL;
+				goto error_free_divelist;
+			}
 
-		// Prepare the command.
-		unsigned char cmd_dive[12] = {0};
-		array_uint32_le_set (cmd_dive + 0, handle);
-		array_uint32_le_set (cmd_dive + 4, 0);
-		array_uint32_le_set (cmd_dive + 8, length);
-
-		// Download the dive.
-		message_t msg_dive = MSG_ECHO;
-		status = divesoft_freedom_transfer (device, &progress, MSG_DIVE_DATA, cmd_dive, sizeof(cmd_dive), &msg_dive, buffer);
-		if (status != DC_STATUS_SUCCESS) {
-			ERROR (abstract->context, "Failed to download the dive.");
-			goto error_free_buffer;
-		}
+			// Verify both dive headers are identical.
+			if (dc_buffer_get_size (buffer) < headersize ||
+				memcmp (header, dc_buffer_get_data (buffer), headersize) != 0) {
+				ERROR (abstract->context, "Unexpected profile header.");
+				status = DC_STATUS_PROTOCOL;
+				goto error_free_divelist;
+			}
 
-		// Check the response message type.
-		if (msg_dive != MSG_DIVE_DATA_RSP) {
-			ERROR (abstract->context, "Unexpected response message (%u).", msg_dive);
-			status = DC_STATUS_PROTOCOL;
-			goto error_free_buffer;
-		}
+			if (callback && !callback (dc_buffer_get_data(buffer), dc_buffer_get_size(buffer), fingerprint, sizeof (device->fingerprint), userdata)) {
+				goto error_free_divelist;
+			}
 
-		// Verify both dive headers are identical.
-		if (dc_buffer_get_size (buffer) < headersize ||
-			memcmp (header, dc_buffer_get_data (buffer), headersize) != 0) {
-			ERROR (abstract->context, "Unexpected profile header.");
-			status = DC_STATUS_PROTOCOL;
-			goto error_free_buffer;
+			// Set the handle for the next request.
+			current = handle;
 		}
 
-		if (callback && !callback (dc_buffer_get_data(buffer), dc_buffer_get_size(buffer), fingerprint, sizeof (device->fingerprint), userdata)) {
+		// Stop downloading if the fingerprint is found, or if there are
+		// no more records.
+		if (found || count < NRECORDS)
 			break;
-		}
-
-		offset += recordsize;
 	}
 
-error_free_buffer:
-	dc_buffer_free (buffer);
 error_free_divelist:
 	dc_buffer_free (divelist);
 error_exit:
@@ -53,12 +53,20 @@
 #define BLACK  0x00
 #define WHITE  0xFF
 
+#define SZ_CACHE 1024
+
 typedef struct hw_ostc_device_t {
 	dc_device_t base;
 	dc_iostream_t *iostream;
 	unsigned char fingerprint[5];
 } hw_ostc_device_t;
 
+typedef struct hw_ostc_cache_t {
+	unsigned char data[SZ_CACHE];
+	unsigned int offset;
+	unsigned int available;
+} hw_ostc_cache_t;
+
 typedef struct hw_ostc_firmware_t {
 	unsigned char data[SZ_FIRMWARE];
 	unsigned char bitmap[SZ_FIRMWARE / SZ_BLOCK];
@@ -84,6 +92,54 @@ static const dc_device_vtable_t hw_ostc_device_vtable = {
 static dc_status_t
 hw_ostc_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
 
+static dc_status_t
+hw_ostc_read_cached (hw_ostc_device_t *device, hw_ostc_cache_t *cache, unsigned char data[], unsigned int size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+
+	unsigned int nbytes = 0;
+	while (nbytes < size) {
+		if (cache->available == 0) {
+			// Read at least the missing number of bytes, and more if
+			// they are immediately available. Because the total size of
+			// the data is not known in advance, waiting for more bytes
+			// than that could block until the timeout expires.
+			size_t len = size - nbytes;
+			size_t available = 0;
+			status = dc_iostream_get_available (device->iostream, &available);
+			if (status == DC_STATUS_SUCCESS && available > len)
+				len = available;
+
+			// Limit the packet size to the cache size.
+			if (len > sizeof (cache->data))
+				len = sizeof (cache->data);
+
+			status = dc_iostream_read (device->iostream, cache->data, len, NULL);
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR (abstract->context, "Failed to receive the packet.");
+				return status;
+			}
+
+			cache->offset = 0;
+			cache->available = len;
+		}
+
+		unsigned int len = size - nbytes;
+		if (len > cache->available)
+			len = cache->available;
+
+		memcpy (data + nbytes, cache->data + cache->offset, len);
+
+		cache->offset += len;
+		cache->available -= len;
+		nbytes += len;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 static dc_status_t
 hw_ostc_send (hw_ostc_device_t *device, unsigned char cmd, unsigned int echo)
 {
@@ -505,20 +561,26 @@ hw_ostc_device_screenshot (dc_device_t *abstract, dc_buffer_t *buffer, hw_ostc_f
 	// Cache the pointer to the image data (RGB formats only).
 	unsigned char *image = dc_buffer_get_data (buffer);
 
+	// The compressed image data is received in large packets, instead of
+	// one run at a time.
+	hw_ostc_cache_t cache;
+	cache.offset = 0;
+	cache.available = 0;
+
 	// The OSTC sends the image data in a column by column layout, which is
 	// converted on the fly to a more convenient row by row layout as used
 	// in the majority of image formats. This conversions requires knowledge
 	// of the pixel coordinates.
 	unsigned int x = 0, y = 0;
+	unsigned int offset = 0;
 
 	unsigned int npixels = 0;
+	unsigned int nbytes_total = 0;
 	while (npixels < WIDTH * HEIGHT) {
 		unsigned char raw[3] = {0};
-		status = dc_iostream_read (device->iostream, raw, 1, NULL);
-		if (status != DC_STATUS_SUCCESS) {
-			ERROR (abstract->context, "Failed to receive the packet.");
+		status = hw_ostc_read_cached (device, &cache, raw, 1);
+		if (status != DC_STATUS_SUCCESS)
 			return status;
-		}
 
 		unsigned int nbytes = 1;
 		unsigned int count = raw[0];
@@ -532,17 +594,17 @@ hw_ostc_device_screenshot (dc_device_t *abstract, dc_buffer_t *buffer, hw_ostc_f
 			count &= 0x3F;
 		} else {
 			// Color pixel.
-			status = dc_iostream_read (device->iostream, raw + 1, 2, NULL);
-			if (status != DC_STATUS_SUCCESS) {
-				ERROR (abstract->context, "Failed to receive the packet.");
+			status = hw_ostc_read_cached (device, &cache, raw + 1, 2);
+			if (status != DC_STATUS_SUCCESS)
 				return status;
-			}
 
 			nbytes += 2;
 			count &= 0x3F;
 		}
 		count++;
 
+		nbytes_total += nbytes;
+
 		// Check for buffer overflows.
 		if (npixels + count > WIDTH * HEIGHT) {
 			ERROR (abstract->context, "Unexpected number of pixels received.");
@@ -556,40 +618,49 @@ hw_ostc_device_screenshot (dc_device_t *abstract, dc_buffer_t *buffer, hw_ostc_f
 				return DC_STATUS_NOMEMORY;
 			}
 		} else {
+			// Convert the color of the run only once.
+			unsigned char pixel[3] = {0};
+			if (format == HW_OSTC_FORMAT_RGB16) {
+				pixel[0] = raw[1];
+				pixel[1] = raw[2];
+			} else {
+				unsigned int value = (raw[1] << 8) + raw[2];
+				unsigned char r = (value & 0xF800) >> 11;
+				unsigned char g = (value & 0x07E0) >> 5;
+				unsigned char b = (value & 0x001F);
+				pixel[0] = 255 * r / 31;
+				pixel[1] = 255 * g / 63;
+				pixel[2] = 255 * b / 31;
+			}
+
 			// Store the decompressed data in the output buffer.
 			for (unsigned int i = 0; i < count; ++i) {
-				// Calculate the offset to the current pixel (row layout)
-				unsigned int offset = (y * WIDTH + x) * bpp;
+				memcpy (image + offset, pixel, bpp);
 
-				if (format == HW_OSTC_FORMAT_RGB16) {
-					image[offset + 0] = raw[1];
-					image[offset + 1] = raw[2];
-				} else {
-					unsigned int value = (raw[1] << 8) + raw[2];
-					unsigned char r = (value & 0xF800) >> 11;
-					unsigned char g = (value & 0x07E0) >> 5;
-					unsigned char b = (value & 0x001F);
-					image[offset + 0] = 255 * r / 31;
-					image[offset + 1] = 255 * g / 63;
-					image[offset + 2] = 255 * b / 31;
-				}
-
-				// Move to the next pixel coordinate (column layout).
+				// Move to the next pixel coordinate (column layout), and
+				// update the offset to the pixel (row layout).
 				y++;
 				if (y == HEIGHT) {
 					y = 0;
 					x++;
+					offset = x * bpp;
+				} else {
+					offset += WIDTH * bpp;
 				}
 			}
 		}
 
-		// Update and emit a progress event.
-		progress.current += count;
-		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
-
 		npixels += count;
+
+		// Update and emit a progress event, once every column.
+		if (npixels % HEIGHT < count || npixels == WIDTH * HEIGHT) {
+			progress.current = npixels;
+			device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+		}
 	}
 
+	DEBUG (abstract->context, "Received %u pixels in %u bytes.", npixels, nbytes_total);
+
 	return DC_STATUS_SUCCESS;
 }
 
@@ -122,6 +122,11 @@ typedef struct hw_ostc_gasmix_t {
 	unsigned int diluent;
 } hw_ostc_gasmix_t;
 
+typedef struct hw_ostc_sample_t {
+	dc_sample_type_t type;
+	dc_sample_value_t value;
+} hw_ostc_sample_t;
+
 typedef struct hw_ostc_parser_t {
 	dc_parser_t base;
 	unsigned int hwos;
@@ -140,13 +145,26 @@ typedef struct hw_ostc_parser_t {
 	unsigned int initial_cns;
 	hw_ostc_gasmix_t gasmix[NGASMIXES];
 	unsigned int current_divemode_ccr;
+	// Decoded samples.
+	dc_buffer_t *samples;
+	size_t limit;
+	size_t accounted;
+	unsigned int overflow;
 } hw_ostc_parser_t;
 
+typedef struct hw_ostc_recorder_t {
+	hw_ostc_parser_t *parser;
+	dc_sample_callback_t callback;
+	void *userdata;
+} hw_ostc_recorder_t;
+
 static dc_status_t hw_ostc_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t hw_ostc_parser_destroy (dc_parser_t *abstract);
 
 static dc_status_t hw_ostc_parser_internal_foreach (hw_ostc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
+static void hw_ostc_parser_cache_free (hw_ostc_parser_t *parser);
 
 static const dc_parser_vtable_t hw_ostc_parser_vtable = {
 	sizeof(hw_ostc_parser_t),
@@ -157,7 +175,7 @@ static const dc_parser_vtable_t hw_ostc_parser_vtable = {
 	hw_ostc_parser_get_datetime, /* datetime */
 	hw_ostc_parser_get_field, /* fields */
 	hw_ostc_parser_samples_foreach, /* samples_foreach */
-	NULL /* destroy */
+	hw_ostc_parser_destroy /* destroy */
 };
 
 static const hw_ostc_layout_t hw_ostc_layout_ostc = {
@@ -440,6 +458,10 @@ hw_ostc_parser_create_internal (dc_parser_t **out, dc_context_t *context, const
 		parser->gasmix[i].diluent = 0;
 	}
 	parser->serial = serial;
+	parser->samples = NULL;
+	parser->limit = 0;
+	parser->accounted = 0;
+	parser->overflow = 0;
 
 	*out = (dc_parser_t *) parser;
 
@@ -459,6 +481,22 @@ hw_ostc3_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned
 	return hw_ostc_parser_create_internal (out, context, data, size, 1, model, serial);
 }
 
+dc_status_t
+hw_ostc_parser_set_cache (dc_parser_t *abstract, size_t limit)
+{
+	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	// Discard the samples cached with the previous limit.
+	hw_ostc_parser_cache_free (parser);
+	parser->limit = limit;
+	parser->overflow = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 hw_ostc_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
 {
@@ -1343,6 +1381,53 @@ hw_ostc_parser_internal_foreach (hw_ostc_parser_t *parser, dc_sample_callback_t
 	return DC_STATUS_SUCCESS;
 }
 
+static void
+hw_ostc_parser_cache_free (hw_ostc_parser_t *parser)
+{
+	dc_buffer_free (parser->samples);
+	parser->samples = NULL;
+
+	dc_context_memory_remove (parser->base.context, DC_MEMORY_PARSER, parser->accounted);
+	parser->accounted = 0;
+}
+
+static void
+hw_ostc_parser_record (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	hw_ostc_recorder_t *recorder = (hw_ostc_recorder_t *) userdata;
+	hw_ostc_parser_t *parser = recorder->parser;
+
+	if (parser->samples) {
+		hw_ostc_sample_t sample;
+		memset (&sample, 0, sizeof (sample));
+		sample.type = type;
+		sample.value = *value;
+
+		// Stop caching once the maximum size is reached. The cached
+		// samples are accounted as parser memory, and are therefore
+		// also subject to the memory limit of the context.
+		if (dc_buffer_get_size (parser->samples) + sizeof (sample) > parser->limit) {
+			WARNING (parser->base.context, "Sample cache disabled (limit of " DC_PRINTF_SIZE " bytes reached).", parser->limit);
+			hw_ostc_parser_cache_free (parser);
+			parser->overflow = 1;
+		} else if (dc_context_memory_add (parser->base.context, DC_MEMORY_PARSER, sizeof (sample)) != DC_STATUS_SUCCESS) {
+			WARNING (parser->base.context, "Sample cache disabled (memory limit reached).");
+			hw_ostc_parser_cache_free (parser);
+			parser->overflow = 1;
+		} else {
+			parser->accounted += sizeof (sample);
+			if (!dc_buffer_append (parser->samples, (const unsigned char *) &sample, sizeof (sample))) {
+				WARNING (parser->base.context, "Sample cache disabled (out of memory).");
+				hw_ostc_parser_cache_free (parser);
+				parser->overflow = 1;
+			}
+		}
+	}
+
+	if (recorder->callback)
+		recorder->callback (type, value, recorder->userdata);
+}
+
 static dc_status_t
 hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
 {
@@ -1353,12 +1438,59 @@ hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t call
 	if (rc != DC_STATUS_SUCCESS)
 		return rc;
 
-	// Cache the profile data.
+	// Replay the decoded samples.
+	if (parser->samples) {
+		const hw_ostc_sample_t *samples = (const hw_ostc_sample_t *) dc_buffer_get_data (parser->samples);
+		size_t nsamples = dc_buffer_get_size (parser->samples) / sizeof (hw_ostc_sample_t);
+		for (size_t i = 0; i < nsamples; ++i) {
+			if (callback) callback (samples[i].type, &samples[i].value, userdata);
+		}
+		return DC_STATUS_SUCCESS;
+	}
+
+	// Cache the profile data. The indices of the gas mixes are only final
+	// after a complete pass, so the samples can't be recorded before.
 	if (parser->cached < PROFILE) {
 		rc = hw_ostc_parser_internal_foreach (parser, NULL, NULL);
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
 	}
 
-	return hw_ostc_parser_internal_foreach (parser, callback, userdata);
+	// Without the cache, fall back to decoding the samples again. The
+	// cache is only enabled when the application sets a sample cache
+	// limit on the parser, and disabled again when the limit is reached.
+	if (parser->limit == 0 || parser->overflow)
+		return hw_ostc_parser_internal_foreach (parser, callback, userdata);
+
+	// Decode the samples, and store them in the cache.
+	parser->samples = dc_buffer_new (0);
+	if (parser->samples == NULL) {
+		ERROR (abstract->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	hw_ostc_recorder_t recorder = {parser, callback, userdata};
+	rc = hw_ostc_parser_internal_foreach (parser, hw_ostc_parser_record, &recorder);
+	if (rc != DC_STATUS_SUCCESS) {
+		hw_ostc_parser_cache_free (parser);
+		return rc;
+	}
+
+	if (parser->samples) {
+		DEBUG (abstract->context, "Cached " DC_PRINTF_SIZE " samples (" DC_PRINTF_SIZE " bytes).",
+			dc_buffer_get_size (parser->samples) / sizeof (hw_ostc_sample_t),
+			dc_buffer_get_size (parser->samples));
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+hw_ostc_parser_destroy (dc_parser_t *abstract)
+{
+	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
+
+	hw_ostc_parser_cache_free (parser);
+
+	return DC_STATUS_SUCCESS;
 }
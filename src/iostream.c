@@ -37,10 +37,15 @@ dc_iostream_allocate (dc_context_t *context, const dc_iostream_vtable_t *vtable,
 	assert(vtable != NULL);
 	assert(vtable->size >= sizeof(dc_iostream_t));
 
+	// Check the memory limit.
+	if (dc_context_memory_add (context, DC_MEMORY_IOSTREAM, vtable->size) != DC_STATUS_SUCCESS)
+		return NULL;
+
 	// Allocate memory.
 	iostream = (dc_iostream_t *) malloc (vtable->size);
 	if (iostream == NULL) {
 		ERROR (context, "Failed to allocate memory.");
+		dc_context_memory_remove (context, DC_MEMORY_IOSTREAM, vtable->size);
 		return iostream;
 	}
 
@@ -55,6 +60,11 @@ dc_iostream_allocate (dc_context_t *context, const dc_iostream_vtable_t *vtable,
 void
 dc_iostream_deallocate (dc_iostream_t *iostream)
 {
+	if (iostream == NULL)
+		return;
+
+	dc_context_memory_remove (iostream->context, DC_MEMORY_IOSTREAM, iostream->vtable->size);
+
 	free (iostream);
 }
 
@@ -34,10 +34,15 @@ dc_iterator_allocate (dc_context_t *context, const dc_iterator_vtable_t *vtable)
 	assert(vtable != NULL);
 	assert(vtable->size >= sizeof(dc_iterator_t));
 
+	// Check the memory limit.
+	if (dc_context_memory_add (context, DC_MEMORY_ITERATOR, vtable->size) != DC_STATUS_SUCCESS)
+		return NULL;
+
 	// Allocate memory.
 	iterator = (dc_iterator_t *) malloc (vtable->size);
 	if (iterator == NULL) {
 		ERROR (context, "Failed to allocate memory.");
+		dc_context_memory_remove (context, DC_MEMORY_ITERATOR, vtable->size);
 		return iterator;
 	}
 
@@ -50,6 +55,11 @@ dc_iterator_allocate (dc_context_t *context, const dc_iterator_vtable_t *vtable)
 void
 dc_iterator_deallocate (dc_iterator_t *iterator)
 {
+	if (iterator == NULL)
+		return;
+
+	dc_context_memory_remove (iterator->context, DC_MEMORY_ITERATOR, iterator->vtable->size);
+
 	free (iterator);
 }
 
@@ -27,6 +27,7 @@
 #include "mares_common.h"
 #include "checksum.h"
 #include "array.h"
+#include "rbstream.h"
 
 #define MAXRETRIES 4
 
@@ -203,37 +204,70 @@ mares_common_device_read (dc_device_t *abstract, unsigned int address, unsigned
 }
 
 
-dc_status_t
-mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *layout, const unsigned char fingerprint[], const unsigned char data[], dc_dive_callback_t callback, void *userdata)
+typedef struct mares_common_stream_t {
+	dc_device_t *device;
+	dc_rbstream_t *rbstream;
+	dc_event_progress_t *progress;
+	unsigned char *buffer;
+	unsigned int size;
+	unsigned int available;
+	unsigned int freedives;
+} mares_common_stream_t;
+
+static dc_status_t
+mares_common_stream_fetch (mares_common_stream_t *stream, unsigned int offset)
 {
-	assert (layout != NULL);
+	// Check whether the data is already available.
+	unsigned int begin = stream->size - stream->available;
+	if (offset >= begin)
+		return DC_STATUS_SUCCESS;
+
+	// Read the missing data from the profile ringbuffer.
+	dc_status_t rc = dc_rbstream_read (stream->rbstream, stream->progress, stream->buffer + offset, begin - offset);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (stream->device->context, "Failed to read the profile data.");
+		return rc;
+	}
 
-	// Get the freedive mode for this model.
-	unsigned int model = data[1];
-	unsigned int freedive = FREEDIVE;
-	if (model == NEMOWIDE || model == NEMOAIR || model == PUCK || model == PUCKAIR)
-		freedive = GAUGE;
+	stream->available = stream->size - offset;
 
-	// Get the end of the profile ring buffer.
-	unsigned int eop = array_uint16_le (data + 0x6B);
-	if (eop < layout->rb_profile_begin || eop >= layout->rb_profile_end) {
-		ERROR (context, "Ringbuffer pointer out of range (0x%04x).", eop);
-		return DC_STATUS_DATAFORMAT;
-	}
+	return DC_STATUS_SUCCESS;
+}
 
-	// Make the ringbuffer linear, to avoid having to deal
-	// with the wrap point. The buffer has extra space to
-	// store the profile data for the freedives.
-	unsigned char *buffer = (unsigned char *) malloc (
-		layout->rb_profile_end - layout->rb_profile_begin +
-		layout->rb_freedives_end - layout->rb_freedives_begin);
-	if (buffer == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		return DC_STATUS_NOMEMORY;
+static dc_status_t
+mares_common_stream_freedives (mares_common_stream_t *stream, const mares_common_layout_t *layout)
+{
+	if (stream->freedives)
+		return DC_STATUS_SUCCESS;
+
+	// Read the freedive profile area. It's stored right after the
+	// linearized profile ringbuffer.
+	unsigned int length = layout->rb_freedives_end - layout->rb_freedives_begin;
+	dc_status_t rc = dc_device_read (stream->device, layout->rb_freedives_begin, stream->buffer + stream->size, length);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (stream->device->context, "Failed to read the freedive data.");
+		return rc;
 	}
 
-	memcpy (buffer + 0, data + eop, layout->rb_profile_end - eop);
-	memcpy (buffer + layout->rb_profile_end - eop, data + layout->rb_profile_begin, eop - layout->rb_profile_begin);
+	// Update and emit a progress event.
+	stream->progress->current += length;
+	device_event_emit (stream->device, DC_EVENT_PROGRESS, stream->progress);
+
+	stream->freedives = 1;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+mares_common_extract (dc_context_t *context, const mares_common_layout_t *layout, const unsigned char fingerprint[], unsigned int model, mares_common_stream_t *stream, dc_dive_callback_t callback, void *userdata)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	unsigned char *buffer = stream->buffer;
+
+	// Get the freedive mode for this model.
+	unsigned int freedive = FREEDIVE;
+	if (model == NEMOWIDE || model == NEMOAIR || model == PUCK || model == PUCKAIR)
+		freedive = GAUGE;
 
 	// For a freedive session, the Mares Nemo stores all the freedives of
 	// that session in a single logbook entry, and each sample is actually
@@ -243,8 +277,12 @@ mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *
 	// number of freedives.
 	unsigned int nfreedives = 0;
 
-	unsigned int offset = layout->rb_profile_end - layout->rb_profile_begin;
+	unsigned int offset = stream->size;
 	while (offset >= 3) {
+		rc = mares_common_stream_fetch (stream, offset - 3);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
 		// Check for the presence of extra header bytes, which can be detected
 		// by means of a three byte marker sequence.
 		unsigned int extra = 0;
@@ -260,6 +298,10 @@ mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *
 		if (offset < extra + 3)
 			break;
 
+		rc = mares_common_stream_fetch (stream, offset - extra - 3);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
 		// Check the dive mode of the logbook entry. Valid modes are
 		// 0 (air), 1 (EANx), 2 (freedive) or 3 (bottom timer).
 		// If the ringbuffer has never reached the wrap point before,
@@ -299,13 +341,16 @@ mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *
 		// Move to the start of the dive.
 		offset -= nbytes;
 
+		rc = mares_common_stream_fetch (stream, offset);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
 		// Verify that the length that is stored in the profile data
 		// equals the calculated length. If both values are different,
 		// something is wrong and an error is returned.
 		unsigned int length = array_uint16_le (buffer + offset);
 		if (length != nbytes) {
 			ERROR (context, "Calculated and stored size are not equal (%u %u).", length, nbytes);
-			free (buffer);
 			return DC_STATUS_DATAFORMAT;
 		}
 
@@ -313,14 +358,19 @@ mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *
 		// Since we are processing the entries backwards (newest to oldest),
 		// this entry will always be the first one.
 		if (mode == freedive && nfreedives == 1) {
+			rc = mares_common_stream_freedives (stream, layout);
+			if (rc != DC_STATUS_SUCCESS)
+				return rc;
+
 			// Count the number of freedives in the profile data.
+			const unsigned char *freedives = buffer + stream->size;
 			unsigned int count = 0;
-			unsigned int idx = layout->rb_freedives_begin;
-			while (idx + 2 <= layout->rb_freedives_end &&
+			unsigned int idx = 0;
+			while (idx + 2 <= layout->rb_freedives_end - layout->rb_freedives_begin &&
 				count != nsamples)
 			{
 				// Each freedive in the session ends with a zero sample.
-				unsigned int sample = array_uint16_le (data + idx);
+				unsigned int sample = array_uint16_le (freedives + idx);
 				if (sample == 0)
 					count++;
 
@@ -333,30 +383,142 @@ mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *
 			// both values are different, the profile data is incomplete.
 			if (count != nsamples) {
 				ERROR (context, "Unexpected number of freedive sessions (%u %u).", count, nsamples);
-				free (buffer);
 				return DC_STATUS_DATAFORMAT;
 			}
 
 			// Append the profile data to the main logbook entry. The
 			// buffer is guaranteed to have enough space, and the dives
 			// that will be overwritten have already been processed.
-			memcpy (buffer + offset + nbytes, data + layout->rb_freedives_begin, idx - layout->rb_freedives_begin);
-			nbytes += idx - layout->rb_freedives_begin;
+			memmove (buffer + offset + nbytes, freedives, idx);
+			nbytes += idx;
 		}
 
 		unsigned int fp_offset = offset + length - extra - FP_OFFSET;
 		if (fingerprint && memcmp (buffer + fp_offset, fingerprint, FP_SIZE) == 0) {
-			free (buffer);
 			return DC_STATUS_SUCCESS;
 		}
 
 		if (callback && !callback (buffer + offset, nbytes, buffer + fp_offset, FP_SIZE, userdata)) {
-			free (buffer);
 			return DC_STATUS_SUCCESS;
 		}
 	}
 
+	return DC_STATUS_SUCCESS;
+}
+
+
+dc_status_t
+mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *layout, const unsigned char fingerprint[], const unsigned char data[], dc_dive_callback_t callback, void *userdata)
+{
+	assert (layout != NULL);
+
+	// Get the end of the profile ring buffer.
+	unsigned int eop = array_uint16_le (data + 0x6B);
+	if (eop < layout->rb_profile_begin || eop >= layout->rb_profile_end) {
+		ERROR (context, "Ringbuffer pointer out of range (0x%04x).", eop);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Make the ringbuffer linear, to avoid having to deal
+	// with the wrap point. The buffer has extra space to
+	// store the profile data for the freedives.
+	unsigned int size = layout->rb_profile_end - layout->rb_profile_begin;
+	unsigned char *buffer = (unsigned char *) malloc (
+		size + layout->rb_freedives_end - layout->rb_freedives_begin);
+	if (buffer == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	memcpy (buffer + 0, data + eop, layout->rb_profile_end - eop);
+	memcpy (buffer + layout->rb_profile_end - eop, data + layout->rb_profile_begin, eop - layout->rb_profile_begin);
+	memcpy (buffer + size, data + layout->rb_freedives_begin, layout->rb_freedives_end - layout->rb_freedives_begin);
+
+	mares_common_stream_t stream = {NULL, NULL, NULL, buffer, size, size, 1};
+	dc_status_t rc = mares_common_extract (context, layout, fingerprint, data[1], &stream, callback, userdata);
+
 	free (buffer);
 
-	return DC_STATUS_SUCCESS;
+	return rc;
+}
+
+
+dc_status_t
+mares_common_device_foreach (dc_device_t *abstract, const mares_common_layout_t *layout, const unsigned char fingerprint[], dc_dive_callback_t callback, void *userdata)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_rbstream_t *rbstream = NULL;
+
+	assert (layout != NULL);
+
+	unsigned int size = layout->rb_profile_end - layout->rb_profile_begin;
+	unsigned int nextra = layout->rb_freedives_end - layout->rb_freedives_begin;
+
+	// Enable progress notifications. The maximum is based on the worst case
+	// scenario, and is corrected once all the required data has been read.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = layout->rb_profile_begin + size + nextra;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Read the header.
+	unsigned char header[0x70] = {0};
+	if (layout->rb_profile_begin > sizeof (header)) {
+		ERROR (abstract->context, "Unexpected header size (%u).", layout->rb_profile_begin);
+		return DC_STATUS_DATAFORMAT;
+	}
+	rc = dc_device_read (abstract, 0, header, layout->rb_profile_begin);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to read the header.");
+		return rc;
+	}
+
+	// Update and emit a progress event.
+	progress.current += layout->rb_profile_begin;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Emit a device info event.
+	dc_event_devinfo_t devinfo;
+	devinfo.model = header[1];
+	devinfo.firmware = 0;
+	devinfo.serial = array_uint16_be (header + 8);
+	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
+
+	// Get the end of the profile ring buffer.
+	unsigned int eop = array_uint16_le (header + 0x6B);
+	if (eop < layout->rb_profile_begin || eop >= layout->rb_profile_end) {
+		ERROR (abstract->context, "Ringbuffer pointer out of range (0x%04x).", eop);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	// Allocate memory for the linearized profile ringbuffer, with extra
+	// space for the freedive profile data.
+	unsigned char *buffer = (unsigned char *) malloc (size + nextra);
+	if (buffer == NULL) {
+		ERROR (abstract->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Create the ringbuffer stream. The profile data is only read on
+	// demand, starting from the most recent dive, such that the download
+	// stops as soon as the fingerprint is found.
+	rc = dc_rbstream_new (&rbstream, abstract, 0x10, PACKETSIZE, layout->rb_profile_begin, layout->rb_profile_end, eop, DC_RBSTREAM_BACKWARD);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to create the ringbuffer stream.");
+		goto error_free_buffer;
+	}
+
+	mares_common_stream_t stream = {abstract, rbstream, &progress, buffer, size, 0, 0};
+	rc = mares_common_extract (abstract->context, layout, fingerprint, header[1], &stream, callback, userdata);
+	if (rc != DC_STATUS_SUCCESS)
+		goto error_free_rbstream;
+
+	// Correct the progress maximum for the data that was not needed.
+	progress.maximum = progress.current;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+error_free_rbstream:
+	dc_rbstream_free (rbstream);
+error_free_buffer:
+	free (buffer);
+	return rc;
 }
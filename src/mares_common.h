@@ -53,6 +53,9 @@ mares_common_device_init (mares_common_device_t *device, dc_iostream_t *iostream
 dc_status_t
 mares_common_device_read (dc_device_t *abstract, unsigned int address, unsigned char data[], unsigned int size);
 
+dc_status_t
+mares_common_device_foreach (dc_device_t *abstract, const mares_common_layout_t *layout, const unsigned char fingerprint[], dc_dive_callback_t callback, void *userdata);
+
 dc_status_t
 mares_common_extract_dives (dc_context_t *context, const mares_common_layout_t *layout, const unsigned char fingerprint[], const unsigned char data[], dc_dive_callback_t callback, void *userdata);
 
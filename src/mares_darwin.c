@@ -30,6 +30,7 @@
 #include "context-private.h"
 #include "device-private.h"
 #include "array.h"
+#include "rbstream.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &mares_darwin_device_vtable)
 
@@ -93,9 +94,6 @@ static const mares_darwin_layout_t mares_darwinair_layout = {
 	3       /* samplesize */
 };
 
-static dc_status_t
-mares_darwin_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 dc_status_t
 mares_darwin_device_open (dc_device_t **out, dc_context_t *context, dc_iostream_t *iostream, unsigned int model)
 {
@@ -222,109 +220,141 @@ mares_darwin_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 static dc_status_t
 mares_darwin_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
+	dc_status_t rc = DC_STATUS_SUCCESS;
 	mares_darwin_device_t *device = (mares_darwin_device_t *) abstract;
+	dc_rbstream_t *rbstream = NULL;
 
 	assert (device->layout != NULL);
 
-	dc_buffer_t *buffer = dc_buffer_new (device->layout->memsize);
-	if (buffer == NULL)
-		return DC_STATUS_NOMEMORY;
+	const mares_darwin_layout_t *layout = device->layout;
 
-	dc_status_t rc = mares_darwin_device_dump (abstract, buffer);
+	// Enable progress notifications. The maximum is based on the worst case
+	// scenario, and is corrected once the new logbook entries are known.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = layout->rb_logbook_offset +
+		layout->rb_logbook_count * layout->rb_logbook_size +
+		layout->rb_profile_end - layout->rb_profile_begin;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Read the header.
+	unsigned char header[0x100] = {0};
+	rc = dc_device_read (abstract, 0, header, layout->rb_logbook_offset);
 	if (rc != DC_STATUS_SUCCESS) {
-		dc_buffer_free (buffer);
+		ERROR (abstract->context, "Failed to read the header.");
 		return rc;
 	}
 
-	rc = mares_darwin_extract_dives (abstract, dc_buffer_get_data (buffer),
-		dc_buffer_get_size (buffer), callback, userdata);
-
-	dc_buffer_free (buffer);
-
-	return rc;
-}
-
+	// Update and emit a progress event.
+	progress.current += layout->rb_logbook_offset;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-static dc_status_t
-mares_darwin_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
-{
-	mares_darwin_device_t *device = (mares_darwin_device_t *) abstract;
-
-	if (!ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
-	assert (device->layout != NULL);
-
-	const mares_darwin_layout_t *layout = device->layout;
+	// Emit a device info event.
+	dc_event_devinfo_t devinfo;
+	devinfo.model = device->model;
+	devinfo.firmware = 0;
+	devinfo.serial = array_uint16_be (header + 8);
+	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
 	// Get the profile pointer.
-	unsigned int eop = array_uint16_be (data + 0x8A);
+	unsigned int eop = array_uint16_be (header + 0x8A);
 	if (eop < layout->rb_profile_begin || eop >= layout->rb_profile_end) {
 		ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%04x).", eop);
 		return DC_STATUS_DATAFORMAT;
 	}
 
 	// Get the logbook index.
-	unsigned int last = data[0x8C];
+	unsigned int last = header[0x8C];
 	if (last >= layout->rb_logbook_count) {
 		ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%02x).", last);
 		return DC_STATUS_DATAFORMAT;
 	}
 
-	// Allocate memory for the largest possible dive.
-	unsigned char *buffer = (unsigned char *) malloc (layout->rb_logbook_size + layout->rb_profile_end - layout->rb_profile_begin);
-	if (buffer == NULL) {
+	// Allocate memory for the logbook entries and the largest possible dive.
+	unsigned int size = layout->rb_logbook_count * layout->rb_logbook_size;
+	unsigned char *logbooks = (unsigned char *) malloc (size + layout->rb_logbook_size + layout->rb_profile_end - layout->rb_profile_begin);
+	if (logbooks == NULL) {
 		ERROR (abstract->context, "Failed to allocate memory.");
 		return DC_STATUS_NOMEMORY;
 	}
 
+	unsigned char *buffer = logbooks + size;
+
 	// The logbook ringbuffer can store a fixed amount of entries, but there
 	// is no guarantee that the profile ringbuffer will contain a profile for
 	// each entry. The number of remaining bytes (which is initialized to the
 	// largest possible value) is used to detect the last valid profile.
 	unsigned int remaining = layout->rb_profile_end - layout->rb_profile_begin;
 
-	unsigned int current = eop;
+	// Read the logbook entries, from newest to oldest, until the
+	// fingerprint or the last valid profile is found.
+	unsigned int ndives = 0;
+	unsigned int nbytes = 0;
 	for (unsigned int i = 0; i < layout->rb_logbook_count; ++i) {
 		// Get the offset to the current logbook entry in the ringbuffer.
 		unsigned int idx = (layout->rb_logbook_count + last - i) % layout->rb_logbook_count;
 		unsigned int offset = layout->rb_logbook_offset + idx * layout->rb_logbook_size;
 
+		unsigned char *logbook = logbooks + i * layout->rb_logbook_size;
+		rc = dc_device_read (abstract, offset, logbook, layout->rb_logbook_size);
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Failed to read the logbook entry.");
+			goto error_free_logbooks;
+		}
+
+		// Update and emit a progress event.
+		progress.current += layout->rb_logbook_size;
+		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
 		// Get the length of the current dive.
-		unsigned int nsamples = array_uint16_be (data + offset + 6);
+		unsigned int nsamples = array_uint16_be (logbook + 6);
 		unsigned int length = nsamples * layout->samplesize;
 		if (nsamples == 0xFFFF || length > remaining)
 			break;
 
+		if (memcmp (logbook, device->fingerprint, sizeof (device->fingerprint)) == 0)
+			break;
+
+		remaining -= length;
+		nbytes += length;
+		ndives++;
+	}
+
+	// Update and emit a progress event.
+	progress.maximum = progress.current + nbytes;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	if (ndives == 0)
+		goto error_free_logbooks;
+
+	// Create the ringbuffer stream.
+	rc = dc_rbstream_new (&rbstream, abstract, 1, PACKETSIZE, layout->rb_profile_begin, layout->rb_profile_end, eop, DC_RBSTREAM_BACKWARD);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to create the ringbuffer stream.");
+		goto error_free_logbooks;
+	}
+
+	for (unsigned int i = 0; i < ndives; ++i) {
+		const unsigned char *logbook = logbooks + i * layout->rb_logbook_size;
+		unsigned int length = array_uint16_be (logbook + 6) * layout->samplesize;
+
 		// Copy the logbook entry.
-		memcpy (buffer, data + offset, layout->rb_logbook_size);
-
-		// Copy the profile data.
-		if (current < layout->rb_profile_begin + length) {
-			unsigned int a = current - layout->rb_profile_begin;
-			unsigned int b = length - a;
-			memcpy (buffer + layout->rb_logbook_size, data + layout->rb_profile_end - b, b);
-			memcpy (buffer + layout->rb_logbook_size + b, data + layout->rb_profile_begin, a);
-			current = layout->rb_profile_end - b;
-		} else {
-			memcpy (buffer + layout->rb_logbook_size, data + current - length, length);
-			current -= length;
-		}
+		memcpy (buffer, logbook, layout->rb_logbook_size);
 
-		if (memcmp (buffer, device->fingerprint, sizeof (device->fingerprint)) == 0) {
-			free (buffer);
-			return DC_STATUS_SUCCESS;
+		// Read the profile data.
+		rc = dc_rbstream_read (rbstream, &progress, buffer + layout->rb_logbook_size, length);
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Failed to read the profile data.");
+			goto error_free_rbstream;
 		}
 
 		if (callback && !callback (buffer, layout->rb_logbook_size + length, buffer, 6, userdata)) {
-			free (buffer);
-			return DC_STATUS_SUCCESS;
+			break;
 		}
-
-		remaining -= length;
 	}
 
-	free (buffer);
-
-	return DC_STATUS_SUCCESS;
+error_free_rbstream:
+	dc_rbstream_free (rbstream);
+error_free_logbooks:
+	free (logbooks);
+	return rc;
 }
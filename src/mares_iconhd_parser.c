@@ -171,6 +171,7 @@ struct mares_iconhd_parser_t {
 	unsigned int model;
 	// Cached fields.
 	unsigned int cached;
+	unsigned int verified;
 	unsigned int logformat;
 	unsigned int mode;
 	unsigned int nsamples;
@@ -661,6 +662,7 @@ mares_iconhd_parser_create (dc_parser_t **out, dc_context_t *context, const unsi
 	// Set the default values.
 	parser->model = model;
 	parser->cached = 0;
+	parser->verified = 0;
 	parser->logformat = 0;
 	parser->mode = ISGENIUS(model) ? GENIUS_AIR : ICONHD_AIR;
 	parser->nsamples = 0;
@@ -1121,17 +1123,21 @@ mares_genius_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void
 			return DC_STATUS_DATAFORMAT;
 		}
 
-		unsigned int etype = array_uint32_be(data + offset + length - 4);
-		if (etype != type) {
-			ERROR (abstract->context, "Invalid record end type (%08x).", etype);
-			return DC_STATUS_DATAFORMAT;
-		}
+		// The records only need to be verified once. The data of the
+		// parser can't change, so the next walks can skip this step.
+		if (!parser->verified) {
+			unsigned int etype = array_uint32_be(data + offset + length - 4);
+			if (etype != type) {
+				ERROR (abstract->context, "Invalid record end type (%08x).", etype);
+				return DC_STATUS_DATAFORMAT;
+			}
 
-		unsigned short crc = array_uint16_le(data + offset + length - 6);
-		unsigned short ccrc = checksum_crc16_ccitt(data + offset + 4, length - 10, 0x0000, 0x0000);
-		if (crc != ccrc) {
-			ERROR (abstract->context, "Invalid record checksum (%04x %04x).", crc, ccrc);
-			return DC_STATUS_DATAFORMAT;
+			unsigned short crc = array_uint16_le(data + offset + length - 6);
+			unsigned short ccrc = checksum_crc16_ccitt(data + offset + 4, length - 10, 0x0000, 0x0000);
+			if (crc != ccrc) {
+				ERROR (abstract->context, "Invalid record checksum (%04x %04x).", crc, ccrc);
+				return DC_STATUS_DATAFORMAT;
+			}
 		}
 
 		if (type == DPRS_TYPE || type == SDPT_TYPE) {
@@ -1261,6 +1267,8 @@ mares_genius_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void
 		offset += length;
 	}
 
+	parser->verified = 1;
+
 	return DC_STATUS_SUCCESS;
 }
 
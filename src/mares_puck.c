@@ -229,20 +229,6 @@ mares_puck_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, v
 
 	assert (device->layout != NULL);
 
-	dc_buffer_t *buffer = dc_buffer_new (device->layout->memsize);
-	if (buffer == NULL)
-		return DC_STATUS_NOMEMORY;
-
-	dc_status_t rc = mares_puck_device_dump (abstract, buffer);
-	if (rc != DC_STATUS_SUCCESS) {
-		dc_buffer_free (buffer);
-		return rc;
-	}
-
-	rc = mares_common_extract_dives (abstract->context, device->layout, device->fingerprint,
-		dc_buffer_get_data (buffer), callback, userdata);
-
-	dc_buffer_free (buffer);
-
-	return rc;
+	return mares_common_device_foreach (abstract, device->layout,
+		device->fingerprint, callback, userdata);
 }
@@ -553,9 +553,15 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 	}
 
 	// Memory buffer for the profile data.
+	rc = dc_context_memory_add (abstract->context, DC_MEMORY_BUFFER, rb_profile_size + rb_logbook_size);
+	if (rc != DC_STATUS_SUCCESS) {
+		dc_rbstream_free (rbstream);
+		return rc;
+	}
 	unsigned char *profiles = (unsigned char *) malloc (rb_profile_size + rb_logbook_size);
 	if (profiles == NULL) {
 		ERROR (abstract->context, "Failed to allocate memory.");
+		dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, rb_profile_size + rb_logbook_size);
 		dc_rbstream_free (rbstream);
 		return DC_STATUS_NOMEMORY;
 	}
@@ -653,6 +659,7 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 
 	dc_rbstream_free (rbstream);
 	free (profiles);
+	dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, rb_profile_size + rb_logbook_size);
 
 	return status;
 }
@@ -35,6 +35,7 @@
 
 #define MAXRETRIES 2
 #define MULTIPAGE  4
+#define NLOGBOOKS  (MULTIPAGE * 2)
 
 #define ACK 0x5A
 #define NAK 0xA5
@@ -360,53 +361,81 @@ oceanic_aeris500ai_device_logbook (dc_device_t *abstract, dc_event_progress_t *p
 	if (!dc_buffer_reserve (logbook, ndives * PAGESIZE / 2))
 		return DC_STATUS_NOMEMORY;
 
-	// Send the logbook index command.
-	unsigned char command[] = {0x52,
-			begin & 0xFF,
-			end   & 0xFF,
-			0x00};
-	rc = oceanic_vtpro_transfer (device, command, sizeof (command), NULL, 0);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR (abstract->context, "Failed to send the logbook index command.");
-		return rc;
-	}
-
-	// Read the logbook index.
-	for (unsigned int i = 0; i < ndives; ++i) {
-		// Receive the answer of the dive computer.
-		unsigned char answer[PAGESIZE / 2 + 1] = {0};
-		rc = dc_iostream_read (device->iostream, answer, sizeof(answer), NULL);
+	// The logbook index is read backwards, in blocks of entries, to
+	// retrieve the most recent entries first. If an already downloaded
+	// entry is identified (by means of its fingerprint), the transfer is
+	// aborted immediately to reduce the transfer time.
+	unsigned int remaining = ndives;
+	while (remaining) {
+		// Calculate the number of entries in the block.
+		unsigned int n = remaining;
+		if (n > NLOGBOOKS)
+			n = NLOGBOOKS;
+
+		// Send the logbook index command.
+		unsigned int first = begin + remaining - n;
+		unsigned int last = first + n - 1;
+		unsigned char command[] = {0x52,
+				first & 0xFF,
+				last  & 0xFF,
+				0x00};
+		rc = oceanic_vtpro_transfer (device, command, sizeof (command), NULL, 0);
 		if (rc != DC_STATUS_SUCCESS) {
-			ERROR (abstract->context, "Failed to receive the answer.");
+			ERROR (abstract->context, "Failed to send the logbook index command.");
 			return rc;
 		}
 
-		// Verify the checksum of the answer.
-		unsigned char crc = answer[PAGESIZE / 2];
-		unsigned char ccrc = checksum_add_uint4 (answer, PAGESIZE / 2, 0x00);
-		if (crc != ccrc) {
-			ERROR (abstract->context, "Unexpected answer checksum.");
-			return DC_STATUS_PROTOCOL;
-		}
+		// Read the logbook index.
+		unsigned char answer[NLOGBOOKS][PAGESIZE / 2 + 1] = {{0}};
+		for (unsigned int i = 0; i < n; ++i) {
+			// Receive the answer of the dive computer.
+			rc = dc_iostream_read (device->iostream, answer[i], sizeof(answer[i]), NULL);
+			if (rc != DC_STATUS_SUCCESS) {
+				ERROR (abstract->context, "Failed to receive the answer.");
+				return rc;
+			}
 
-		// Update and emit a progress event.
-		progress->current += PAGESIZE / 2;
-		device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
+			// Verify the checksum of the answer.
+			unsigned char crc = answer[i][PAGESIZE / 2];
+			unsigned char ccrc = checksum_add_uint4 (answer[i], PAGESIZE / 2, 0x00);
+			if (crc != ccrc) {
+				ERROR (abstract->context, "Unexpected answer checksum.");
+				return DC_STATUS_PROTOCOL;
+			}
 
-		// Ignore uninitialized entries.
-		if (array_isequal (answer, PAGESIZE / 2, 0xFF)) {
-			WARNING (abstract->context, "Uninitialized logbook entries detected!");
-			continue;
+			// Update and emit a progress event.
+			progress->current += PAGESIZE / 2;
+			device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 		}
 
-		// Compare the fingerprint to identify previously downloaded entries.
-		if (memcmp (answer, device->base.fingerprint, PAGESIZE / 2) == 0) {
-			dc_buffer_clear (logbook);
-		} else {
-			dc_buffer_append (logbook, answer, PAGESIZE / 2);
+		remaining -= n;
+
+		// Process the entries from newest to oldest.
+		unsigned int found = 0;
+		for (unsigned int i = n; i > 0; --i) {
+			// Ignore uninitialized entries.
+			if (array_isequal (answer[i - 1], PAGESIZE / 2, 0xFF)) {
+				WARNING (abstract->context, "Uninitialized logbook entries detected!");
+				continue;
+			}
+
+			// Compare the fingerprint to identify previously downloaded entries.
+			if (memcmp (answer[i - 1], device->base.fingerprint, PAGESIZE / 2) == 0) {
+				found = 1;
+				break;
+			}
+
+			dc_buffer_prepend (logbook, answer[i - 1], PAGESIZE / 2);
 		}
+
+		if (found)
+			break;
 	}
 
+	// Update and emit a progress event.
+	progress->maximum -= remaining * PAGESIZE / 2;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
+
 	return DC_STATUS_SUCCESS;
 }
 
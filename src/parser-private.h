@@ -43,6 +43,8 @@ struct dc_parser_t {
 	dc_context_t *context;
 	unsigned char *data;
 	unsigned int size;
+	// Size of the allocated memory.
+	size_t allocated;
 };
 
 struct dc_parser_vtable_t {
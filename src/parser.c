@@ -265,22 +265,30 @@ dc_parser_allocate (dc_context_t *context, const dc_parser_vtable_t *vtable, con
 	assert(vtable != NULL);
 	assert(vtable->size >= sizeof(dc_parser_t));
 
+	// Check the memory limit.
+	size_t allocated = vtable->size + size;
+	if (dc_context_memory_add (context, DC_MEMORY_PARSER, allocated) != DC_STATUS_SUCCESS)
+		return NULL;
+
 	// Allocate memory.
 	parser = (dc_parser_t *) malloc (vtable->size);
 	if (parser == NULL) {
 		ERROR (context, "Failed to allocate memory.");
+		dc_context_memory_remove (context, DC_MEMORY_PARSER, allocated);
 		return parser;
 	}
 
 	// Initialize the base class.
 	parser->vtable = vtable;
 	parser->context = context;
+	parser->allocated = allocated;
 
 	if (size) {
 		// Allocate memory for the data.
 		parser->data = malloc (size);
 		if (parser->data == NULL) {
 			ERROR (context, "Failed to allocate memory.");
+			dc_context_memory_remove (context, DC_MEMORY_PARSER, allocated);
 			free (parser);
 			return NULL;
 		}
@@ -291,8 +299,8 @@ dc_parser_allocate (dc_context_t *context, const dc_parser_vtable_t *vtable, con
 	} else {
 		parser->data = NULL;
 		parser->size = 0;
-
 	}
+
 	return parser;
 }
 
@@ -302,6 +310,8 @@ dc_parser_deallocate (dc_parser_t *parser)
 	if (parser == NULL)
 		return;
 
+	dc_context_memory_remove (parser->context, DC_MEMORY_PARSER, parser->allocated);
+
 	free (parser->data);
 	free (parser);
 }
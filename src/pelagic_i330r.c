@@ -286,16 +286,29 @@ static dc_status_t
 pelagic_i330r_init_accesscode (pelagic_i330r_device_t *device)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
 
 	const unsigned char zero[9] = {0};
 	status = pelagic_i330r_transfer (device, CMD_ACCESS_REQUEST, FLAG_REQUEST, zero, sizeof(zero), NULL, 0, RSP_READY);
 	if (status != DC_STATUS_SUCCESS)
 		return status;
 
-	status = pelagic_i330r_transfer (device, CMD_ACCESS_REQUEST, FLAG_DATA, device->accesscode, sizeof(device->accesscode), NULL, 0, RSP_DONE);
+	status = pelagic_i330r_send (device, CMD_ACCESS_REQUEST, FLAG_DATA, device->accesscode, sizeof(device->accesscode));
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	unsigned int errorcode = 0;
+	status = pelagic_i330r_recv (device, CMD_ACCESS_REQUEST, NULL, 0, &errorcode);
 	if (status != DC_STATUS_SUCCESS)
 		return status;
 
+	// A valid response with an unexpected response code indicates the
+	// access code is rejected by the dive computer.
+	if (errorcode != RSP_DONE) {
+		DEBUG (abstract->context, "Access code rejected (%u).", errorcode);
+		return DC_STATUS_NOACCESS;
+	}
+
 	return status;
 }
 
@@ -388,6 +401,22 @@ pelagic_i330r_init (pelagic_i330r_device_t *device)
 		return status;
 	}
 
+	// Request access with the stored access code. If the dive computer
+	// explicitly rejects it (e.g. after a reset of the pairing), fall back
+	// to requesting a new access code. Any other failure, including a
+	// corrupted response packet, is fatal and keeps the stored code.
+	if (!array_isequal (device->accesscode, sizeof(device->accesscode), 0)) {
+		status = pelagic_i330r_init_accesscode (device);
+		if (status == DC_STATUS_NOACCESS) {
+			WARNING (abstract->context, "The stored access code was rejected.");
+			memset (device->accesscode, 0, sizeof(device->accesscode));
+			dc_iostream_purge (device->iostream, DC_DIRECTION_INPUT);
+		} else if (status != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Failed to request access.");
+			return status;
+		}
+	}
+
 	if (array_isequal (device->accesscode, sizeof(device->accesscode), 0)) {
 		// Request to display the PIN code.
 		status = pelagic_i330r_init_accesscode (device);
@@ -420,13 +449,13 @@ pelagic_i330r_init (pelagic_i330r_device_t *device)
 			ERROR (abstract->context, "Failed to store the access code.");
 			return status;
 		}
-	}
 
-	// Request access.
-	status = pelagic_i330r_init_accesscode (device);
-	if (status != DC_STATUS_SUCCESS) {
-		ERROR (abstract->context, "Failed to request access.");
-		return status;
+		// Request access.
+		status = pelagic_i330r_init_accesscode (device);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Failed to request access.");
+			return status;
+		}
 	}
 
 	// Send the wakeup command.
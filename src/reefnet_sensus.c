@@ -263,8 +263,8 @@ reefnet_sensus_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	dc_status_t status = DC_STATUS_SUCCESS;
 	reefnet_sensus_device_t *device = (reefnet_sensus_device_t*) abstract;
 
-	// Pre-allocate the required amount of memory.
-	if (!dc_buffer_reserve (buffer, SZ_MEMORY)) {
+	// Allocate the required amount of memory.
+	if (!dc_buffer_resize (buffer, SZ_MEMORY)) {
 		ERROR (abstract->context, "Insufficient buffer space available.");
 		return DC_STATUS_NOMEMORY;
 	}
@@ -290,20 +290,42 @@ reefnet_sensus_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	// The device leaves the waiting state.
 	device->waiting = 0;
 
-	// Receive the answer from the device.
+	// Receive the header of the package.
+	unsigned char header[4] = {0};
+	status = dc_iostream_read (device->iostream, header, sizeof (header), NULL);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to receive the answer.");
+		return status;
+	}
+
+	// Update and emit a progress event.
+	progress.current += sizeof (header);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Verify the header of the package.
+	if (memcmp (header, "DATA", 4) != 0) {
+		ERROR (abstract->context, "Unexpected answer start byte(s).");
+		return DC_STATUS_PROTOCOL;
+	}
+
+	// Receive the memory directly into the output buffer. The checksum
+	// is updated after each chunk, while the device is still sending.
+	unsigned char *data = dc_buffer_get_data (buffer);
+	unsigned short ccrc = 0x00;
 	unsigned int nbytes = 0;
-	unsigned char answer[4 + SZ_MEMORY + 2 + 3] = {0};
-	while (nbytes < sizeof (answer)) {
-		unsigned int len = sizeof (answer) - nbytes;
+	while (nbytes < SZ_MEMORY) {
+		unsigned int len = SZ_MEMORY - nbytes;
 		if (len > 128)
 			len = 128;
 
-		status = dc_iostream_read (device->iostream, answer + nbytes, len, NULL);
+		status = dc_iostream_read (device->iostream, data + nbytes, len, NULL);
 		if (status != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to receive the answer.");
 			return status;
 		}
 
+		ccrc = checksum_add_uint16 (data + nbytes, len, ccrc);
+
 		// Update and emit a progress event.
 		progress.current += len;
 		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
@@ -311,23 +333,31 @@ reefnet_sensus_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 		nbytes += len;
 	}
 
-	// Verify the headers of the package.
-	if (memcmp (answer, "DATA", 4) != 0 ||
-		memcmp (answer + sizeof (answer) - 3, "END", 3) != 0) {
-		ERROR (abstract->context, "Unexpected answer start or end byte(s).");
+	// Receive the checksum and the trailer of the package.
+	unsigned char trailer[2 + 3] = {0};
+	status = dc_iostream_read (device->iostream, trailer, sizeof (trailer), NULL);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to receive the answer.");
+		return status;
+	}
+
+	// Update and emit a progress event.
+	progress.current += sizeof (trailer);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Verify the trailer of the package.
+	if (memcmp (trailer + 2, "END", 3) != 0) {
+		ERROR (abstract->context, "Unexpected answer end byte(s).");
 		return DC_STATUS_PROTOCOL;
 	}
 
 	// Verify the checksum of the package.
-	unsigned short crc = array_uint16_le (answer + 4 + SZ_MEMORY);
-	unsigned short ccrc = checksum_add_uint16 (answer + 4, SZ_MEMORY, 0x00);
+	unsigned short crc = array_uint16_le (trailer);
 	if (crc != ccrc) {
 		ERROR (abstract->context, "Unexpected answer checksum.");
 		return DC_STATUS_PROTOCOL;
 	}
 
-	dc_buffer_append (buffer, answer + 4, SZ_MEMORY);
-
 	return DC_STATUS_SUCCESS;
 }
 
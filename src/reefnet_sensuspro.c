@@ -243,8 +243,8 @@ reefnet_sensuspro_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	dc_status_t status = DC_STATUS_SUCCESS;
 	reefnet_sensuspro_device_t *device = (reefnet_sensuspro_device_t*) abstract;
 
-	// Pre-allocate the required amount of memory.
-	if (!dc_buffer_reserve (buffer, SZ_MEMORY)) {
+	// Allocate the required amount of memory.
+	if (!dc_buffer_resize (buffer, SZ_MEMORY)) {
 		ERROR (abstract->context, "Insufficient buffer space available.");
 		return DC_STATUS_NOMEMORY;
 	}
@@ -259,19 +259,24 @@ reefnet_sensuspro_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	if (rc != DC_STATUS_SUCCESS)
 		return rc;
 
+	// Receive the memory directly into the output buffer. The checksum
+	// is updated after each chunk, while the device is still sending.
+	unsigned char *data = dc_buffer_get_data (buffer);
+	unsigned short ccrc = 0xffff;
 	unsigned int nbytes = 0;
-	unsigned char answer[SZ_MEMORY + 2] = {0};
-	while (nbytes < sizeof (answer)) {
-		unsigned int len = sizeof (answer) - nbytes;
+	while (nbytes < SZ_MEMORY) {
+		unsigned int len = SZ_MEMORY - nbytes;
 		if (len > 256)
 			len = 256;
 
-		status = dc_iostream_read (device->iostream, answer + nbytes, len, NULL);
+		status = dc_iostream_read (device->iostream, data + nbytes, len, NULL);
 		if (status != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to receive the answer.");
 			return status;
 		}
 
+		ccrc = checksum_crc16_ccitt (data + nbytes, len, ccrc, 0x0000);
+
 		// Update and emit a progress event.
 		progress.current += len;
 		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
@@ -279,15 +284,24 @@ reefnet_sensuspro_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 		nbytes += len;
 	}
 
-	unsigned short crc = array_uint16_le (answer + SZ_MEMORY);
-	unsigned short ccrc = checksum_crc16_ccitt (answer, SZ_MEMORY, 0xffff, 0x0000);
+	// Receive the checksum.
+	unsigned char checksum[2] = {0};
+	status = dc_iostream_read (device->iostream, checksum, sizeof (checksum), NULL);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to receive the answer.");
+		return status;
+	}
+
+	// Update and emit a progress event.
+	progress.current += sizeof (checksum);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	unsigned short crc = array_uint16_le (checksum);
 	if (crc != ccrc) {
 		ERROR (abstract->context, "Unexpected answer checksum.");
 		return DC_STATUS_PROTOCOL;
 	}
 
-	dc_buffer_append (buffer, answer, SZ_MEMORY);
-
 	return DC_STATUS_SUCCESS;
 }
 
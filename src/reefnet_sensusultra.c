@@ -692,6 +692,15 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 			return DC_STATUS_NOMEMORY;
 		}
 
+		// Accept the packet. The page is already verified and stored, so
+		// the device can start sending the next page while the current
+		// one is being parsed and passed to the application.
+		rc = reefnet_sensusultra_send_uchar (device, ACCEPT);
+		if (rc != DC_STATUS_SUCCESS) {
+			dc_buffer_free (buffer);
+			return rc;
+		}
+
 		// Update the parser state.
 		remaining += SZ_PACKET;
 		previous += SZ_PACKET;
@@ -707,13 +716,6 @@ reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t ca
 		if (aborted)
 			break;
 
-		// Accept the packet.
-		rc = reefnet_sensusultra_send_uchar (device, ACCEPT);
-		if (rc != DC_STATUS_SUCCESS) {
-			dc_buffer_free (buffer);
-			return rc;
-		}
-
 		nbytes += SZ_PACKET;
 		npages++;
 	}
@@ -53,11 +53,21 @@
 #define SZ_HEADER   32
 #define SZ_SAMPLE    4
 
+#define FP_OFFSET    2
+#define FP_SIZE      6
+
+typedef struct sporasub_sp2_logbook_t {
+	unsigned int address;
+	unsigned int length;
+	unsigned int cached;
+	unsigned char data[SZ_READ];
+} sporasub_sp2_logbook_t;
+
 typedef struct sporasub_sp2_device_t {
 	dc_device_t base;
 	dc_iostream_t *iostream;
 	unsigned char version[SZ_VERSION];
-	unsigned char fingerprint[6];
+	unsigned char fingerprint[FP_SIZE];
 } sporasub_sp2_device_t;
 
 static dc_status_t sporasub_sp2_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
@@ -373,38 +383,73 @@ sporasub_sp2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 	dc_status_t status = DC_STATUS_SUCCESS;
 	sporasub_sp2_device_t *device = (sporasub_sp2_device_t *) abstract;
 
-	dc_buffer_t *buffer = dc_buffer_new (SZ_MEMORY);
-	if (buffer == NULL) {
-		status = DC_STATUS_NOMEMORY;
-		goto error_exit;
-	}
+	// Enable progress notifications.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = SZ_MEMORY;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	status = sporasub_sp2_device_dump (abstract, buffer);
+	// Emit a device info event.
+	dc_event_devinfo_t devinfo;
+	devinfo.model = 0;
+	devinfo.firmware = 0;
+	devinfo.serial = array_uint16_be (device->version + 1);
+	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
+
+	// Emit a vendor event.
+	dc_event_vendor_t vendor;
+	vendor.data = device->version;
+	vendor.size = sizeof (device->version);
+	device_event_emit (abstract, DC_EVENT_VENDOR, &vendor);
+
+	// Read the memory header.
+	unsigned char config[RB_PROFILE_BEGIN] = {0};
+	status = sporasub_sp2_device_read (abstract, 0, config, sizeof (config));
 	if (status != DC_STATUS_SUCCESS) {
-		goto error_free_buffer;
+		ERROR (abstract->context, "Failed to read the memory header.");
+		goto error_exit;
 	}
 
-	unsigned char *data = dc_buffer_get_data (buffer);
+	// Update and emit a progress event.
+	progress.current += sizeof (config);
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
 	// Get the number of dives.
-	unsigned int ndives = array_uint16_le (data + 0x02);
+	unsigned int ndives = array_uint16_le (config + 0x02);
 
 	// Get the profile pointer.
-	unsigned int eop = array_uint16_le (data + 0x04);
+	unsigned int eop = array_uint16_le (config + 0x04);
 	if (eop < RB_PROFILE_BEGIN || eop > RB_PROFILE_END) {
 		ERROR (abstract->context, "Invalid profile pointer (0x%04x).", eop);
 		status = DC_STATUS_DATAFORMAT;
-		goto error_free_buffer;
+		goto error_exit;
+	}
+
+	if (ndives == 0)
+		goto error_exit;
+
+	// The dives are stored in the profile ringbuffer with at least one
+	// header each, which limits the maximum number of dives.
+	if (ndives > (RB_PROFILE_END - RB_PROFILE_BEGIN) / SZ_HEADER) {
+		ERROR (abstract->context, "Invalid number of dives (%u).", ndives);
+		status = DC_STATUS_DATAFORMAT;
+		goto error_exit;
 	}
 
-	unsigned short *logbook = (unsigned short *) malloc(ndives * sizeof (unsigned short));
+	sporasub_sp2_logbook_t *logbook = (sporasub_sp2_logbook_t *) malloc (ndives * sizeof (sporasub_sp2_logbook_t));
 	if (logbook == NULL) {
 		ERROR (abstract->context, "Out of memory.");
 		status = DC_STATUS_NOMEMORY;
-		goto error_free_buffer;
+		goto error_exit;
 	}
 
-	// Find all dives.
+	// Find all dives. The dives are stored back-to-back, so only the
+	// header of each dive is needed to locate the next one. The memory
+	// is read forward in packets of the maximum size, and consecutive
+	// headers are taken from the last packet whenever it contains them.
+	// The first part of each dive is kept, so it doesn't need to be
+	// read again when the dive is downloaded.
+	unsigned char packet[SZ_READ] = {0};
+	unsigned int paddress = 0, psize = 0;
 	unsigned int count = 0;
 	unsigned int address = RB_PROFILE_BEGIN;
 	while (address + SZ_HEADER <= RB_PROFILE_END && count < ndives) {
@@ -413,43 +458,146 @@ sporasub_sp2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 			break;
 		}
 
+		// Read the next packet, unless it contains the dive header already.
+		if (address < paddress || address + SZ_HEADER > paddress + psize) {
+			unsigned int len = RB_PROFILE_END - address;
+			if (len > SZ_READ)
+				len = SZ_READ;
+
+			status = sporasub_sp2_device_read (abstract, address, packet, len);
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR (abstract->context, "Failed to read the dive header.");
+				goto error_free_logbook;
+			}
+
+			paddress = address;
+			psize = len;
+
+			// Update and emit a progress event.
+			progress.current += len;
+			device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+		}
+
+		const unsigned char *header = packet + (address - paddress);
+
 		// Get the dive length.
-		unsigned int nsamples = array_uint16_le (data + address);
+		unsigned int nsamples = array_uint16_le (header);
 		unsigned int length = SZ_HEADER + nsamples * SZ_SAMPLE;
 		if (address + length > RB_PROFILE_END) {
 			WARNING (abstract->context, "Reached end of memory.");
 			break;
 		}
 
-		// Store the address.
-		logbook[count] = address;
+		// Keep the part of the dive that is already available.
+		unsigned int cached = paddress + psize - address;
+		if (cached > iceil (length, SZ_HEADER))
+			cached = iceil (length, SZ_HEADER);
+		memcpy (logbook[count].data, header, cached);
+
+		// Store the address and length.
+		logbook[count].address = address;
+		logbook[count].length = length;
+		logbook[count].cached = cached;
 		count++;
 
 		// The start of the next dive is always aligned to 32 bytes.
 		address += iceil (length, SZ_HEADER);
 	}
 
-	// Process the dives in reverse order (newest first).
+	// Count the new dives (newest first), and calculate the amount of
+	// profile data that still needs to be downloaded.
+	unsigned int nnew = 0;
+	unsigned int total = 0;
 	for (unsigned int i = 0; i < count; ++i) {
 		unsigned int idx = count - 1 - i;
-		unsigned int offset = logbook[idx];
-
-		// Get the dive length.
-		unsigned int nsamples = array_uint16_le (data + offset);
-		unsigned int length = SZ_HEADER + nsamples * SZ_SAMPLE;
 
 		// Check the fingerprint data.
-		if (memcmp (data + offset + 2, device->fingerprint, sizeof (device->fingerprint)) == 0)
+		if (memcmp (logbook[idx].data + FP_OFFSET, device->fingerprint, sizeof (device->fingerprint)) == 0)
 			break;
 
-		if (callback && !callback (data + offset, length, data + offset + 2, sizeof (device->fingerprint), userdata)) {
-			break;
+		total += iceil (logbook[idx].length, SZ_HEADER) - logbook[idx].cached;
+		nnew++;
+	}
+
+	// Update and emit a progress event.
+	progress.maximum = progress.current + total;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Exit if no dives to download.
+	if (nnew == 0)
+		goto error_free_logbook;
+
+	// The new dives are stored back-to-back, in one continuous range.
+	unsigned int first = count - nnew;
+	unsigned int begin = logbook[first].address;
+	unsigned int end = logbook[count - 1].address + iceil (logbook[count - 1].length, SZ_HEADER);
+
+	// Allocate memory for the new dives.
+	unsigned char *buffer = (unsigned char *) malloc (end - begin);
+	if (buffer == NULL) {
+		ERROR (abstract->context, "Out of memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free_logbook;
+	}
+
+	// Copy the part of the dives that is already available.
+	for (unsigned int i = first; i < count; ++i) {
+		memcpy (buffer + logbook[i].address - begin, logbook[i].data, logbook[i].cached);
+	}
+
+	// Process the dives in reverse order (newest first). The remainders of
+	// consecutive dives are only separated by the part that is already
+	// available. They are downloaded with a single read, whenever that
+	// doesn't need more packets than reading them separately.
+	unsigned int idx = count;
+	while (idx > first) {
+		unsigned int last = idx;
+		unsigned int lo = 0, hi = 0;
+		unsigned int nbytes = 0;
+		while (idx > first) {
+			const sporasub_sp2_logbook_t *dive = logbook + idx - 1;
+			unsigned int a = dive->address + dive->cached;
+			unsigned int b = dive->address + iceil (dive->length, SZ_HEADER);
+			if (a < b) {
+				if (hi == 0) {
+					lo = a;
+					hi = b;
+				} else {
+					unsigned int separate = iceil (hi - lo, SZ_READ) + iceil (b - a, SZ_READ);
+					if (iceil (hi - a, SZ_READ) > separate)
+						break;
+					lo = a;
+				}
+			}
+			nbytes += b - a;
+			idx--;
+		}
+
+		// Read the remainder of the dives, including the alignment padding.
+		if (hi) {
+			status = sporasub_sp2_device_read (abstract, lo, buffer + lo - begin, hi - lo);
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR (abstract->context, "Failed to read the dive.");
+				goto error_free_buffer;
+			}
+
+			// Update and emit a progress event.
+			progress.current += nbytes;
+			device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+		}
+
+		for (unsigned int i = last; i > idx; --i) {
+			unsigned char *p = buffer + logbook[i - 1].address - begin;
+			if (callback && !callback (p, logbook[i - 1].length, p + FP_OFFSET, sizeof (device->fingerprint), userdata)) {
+				goto error_free_buffer;
+			}
 		}
 	}
 
-	free (logbook);
 error_free_buffer:
-	dc_buffer_free (buffer);
+	free (buffer);
+error_free_logbook:
+	free (logbook);
 error_exit:
 	return status;
 }
@@ -314,9 +314,16 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 	}
 
 	// Memory buffer to store all the dives.
-	unsigned char *data = (unsigned char *) malloc (layout->rb_profile_end - layout->rb_profile_begin);
+	unsigned int capacity = layout->rb_profile_end - layout->rb_profile_begin;
+	rc = dc_context_memory_add (abstract->context, DC_MEMORY_BUFFER, capacity);
+	if (rc != DC_STATUS_SUCCESS) {
+		dc_rbstream_free (rbstream);
+		return rc;
+	}
+	unsigned char *data = (unsigned char *) malloc (capacity);
 	if (data == NULL) {
 		ERROR (abstract->context, "Failed to allocate memory.");
+		dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, capacity);
 		dc_rbstream_free (rbstream);
 		return DC_STATUS_NOMEMORY;
 	}
@@ -334,6 +341,7 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 			ERROR (abstract->context, "Unexpected profile size (%u %u).", size, offset);
 			dc_rbstream_free (rbstream);
 			free (data);
+			dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, capacity);
 			return DC_STATUS_DATAFORMAT;
 		}
 
@@ -346,6 +354,7 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 			ERROR (abstract->context, "Failed to read the dive.");
 			dc_rbstream_free (rbstream);
 			free (data);
+			dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, capacity);
 			return rc;
 		}
 
@@ -360,12 +369,14 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 			ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%04x 0x%04x).", prev, next);
 			dc_rbstream_free (rbstream);
 			free (data);
+			dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, capacity);
 			return DC_STATUS_DATAFORMAT;
 		}
 		if (next != previous && next != current) {
 			ERROR (abstract->context, "Profiles are not continuous (0x%04x 0x%04x 0x%04x).", current, next, previous);
 			dc_rbstream_free (rbstream);
 			free (data);
+			dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, capacity);
 			return DC_STATUS_DATAFORMAT;
 		}
 
@@ -374,12 +385,14 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 			if (memcmp (p + fp_offset, device->fingerprint, sizeof (device->fingerprint)) == 0) {
 				dc_rbstream_free (rbstream);
 				free (data);
+				dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, capacity);
 				return DC_STATUS_SUCCESS;
 			}
 
 			if (callback && !callback (p + 4, size - 4, p + fp_offset, sizeof (device->fingerprint), userdata)) {
 				dc_rbstream_free (rbstream);
 				free (data);
+				dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, capacity);
 				return DC_STATUS_SUCCESS;
 			}
 		} else {
@@ -394,6 +407,7 @@ suunto_common2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callbac
 
 	dc_rbstream_free (rbstream);
 	free (data);
+	dc_context_memory_remove (abstract->context, DC_MEMORY_BUFFER, capacity);
 
 	return status;
 }
@@ -376,6 +376,7 @@ suunto_vyper_read_dive (dc_device_t *abstract, dc_buffer_t *buffer, int init, dc
 		// the current dive has been overwritten with newer data. Therefore,
 		// we discard the current (incomplete) dive and end the transmission.
 		if (len == 0) {
+			DEBUG (abstract->context, "End of the ringbuffer reached after %u bytes.", nbytes);
 			dc_buffer_clear (buffer);
 			return DC_STATUS_SUCCESS;
 		}
@@ -407,6 +408,8 @@ suunto_vyper_read_dive (dc_device_t *abstract, dc_buffer_t *buffer, int init, dc
 #endif
 	}
 
+	DEBUG (abstract->context, "Received a dive of %u bytes.", nbytes);
+
 	// Check for a buffer error.
 	if (dc_buffer_get_size (buffer) != nbytes) {
 		ERROR (abstract->context, "Insufficient buffer space available.");
@@ -0,0 +1,764 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 libdivecomputer contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h> // malloc, free
+#include <stdio.h>  // snprintf
+#include <string.h> // memset, memcpy, memmove
+
+#include "socket.h"
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+#include <libdivecomputer/tcp.h>
+
+#include "common-private.h"
+#include "context-private.h"
+#include "iostream-private.h"
+#include "array.h"
+#include "platform.h"
+#include "timer.h"
+
+#define ISINSTANCE(device) dc_iostream_isinstance((device), &dc_tcp_vtable)
+
+#define SZ_BUFFER 256
+
+// Telnet commands (RFC 854).
+#define SE   240
+#define SB   250
+#define WILL 251
+#define WONT 252
+#define DO   253
+#define DONT 254
+#define IAC  255
+
+// Telnet options.
+#define OPT_BINARY  0
+#define OPT_SGA     3
+#define OPT_COMPORT 44
+
+// COM port control commands (RFC 2217).
+#define SET_BAUDRATE 1
+#define SET_DATASIZE 2
+#define SET_PARITY   3
+#define SET_STOPSIZE 4
+#define SET_CONTROL  5
+#define PURGE_DATA   12
+
+#define CONTROL_FLOW_NONE     1
+#define CONTROL_FLOW_XONXOFF  2
+#define CONTROL_FLOW_HARDWARE 3
+#define CONTROL_BREAK_ON      5
+#define CONTROL_BREAK_OFF     6
+#define CONTROL_DTR_ON        8
+#define CONTROL_DTR_OFF       9
+#define CONTROL_RTS_ON        11
+#define CONTROL_RTS_OFF       12
+
+#define PURGE_RX   1
+#define PURGE_TX   2
+#define PURGE_BOTH 3
+
+typedef enum dc_tcp_state_t {
+	STATE_DATA,
+	STATE_IAC,
+	STATE_OPTION,
+	STATE_SB,
+	STATE_SB_IAC,
+} dc_tcp_state_t;
+
+typedef struct dc_tcp_t {
+	dc_socket_t base;
+	dc_tcp_protocol_t protocol;
+	dc_tcp_state_t state;
+	unsigned int command;
+	dc_timer_t *timer;
+	/* Decoded data bytes, not yet returned by a read. */
+	unsigned char buffer[SZ_BUFFER];
+	size_t offset;
+	size_t available;
+} dc_tcp_t;
+
+static dc_status_t dc_tcp_set_break (dc_iostream_t *iostream, unsigned int value);
+static dc_status_t dc_tcp_set_dtr (dc_iostream_t *iostream, unsigned int value);
+static dc_status_t dc_tcp_set_rts (dc_iostream_t *iostream, unsigned int value);
+static dc_status_t dc_tcp_get_available (dc_iostream_t *iostream, size_t *value);
+static dc_status_t dc_tcp_configure (dc_iostream_t *iostream, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol);
+static dc_status_t dc_tcp_poll (dc_iostream_t *iostream, int timeout);
+static dc_status_t dc_tcp_read (dc_iostream_t *iostream, void *data, size_t size, size_t *actual);
+static dc_status_t dc_tcp_write (dc_iostream_t *iostream, const void *data, size_t size, size_t *actual);
+static dc_status_t dc_tcp_purge (dc_iostream_t *iostream, dc_direction_t direction);
+static dc_status_t dc_tcp_close (dc_iostream_t *iostream);
+
+static const dc_iostream_vtable_t dc_tcp_vtable = {
+	sizeof(dc_tcp_t),
+	dc_socket_set_timeout, /* set_timeout */
+	dc_tcp_set_break, /* set_break */
+	dc_tcp_set_dtr, /* set_dtr */
+	dc_tcp_set_rts, /* set_rts */
+	NULL, /* get_lines */
+	dc_tcp_get_available, /* get_available */
+	dc_tcp_configure, /* configure */
+	dc_tcp_poll, /* poll */
+	dc_tcp_read, /* read */
+	dc_tcp_write, /* write */
+	dc_socket_ioctl, /* ioctl */
+	NULL, /* flush */
+	dc_tcp_purge, /* purge */
+	dc_socket_sleep, /* sleep */
+	dc_tcp_close, /* close */
+};
+
+static dc_status_t
+dc_tcp_comport (dc_tcp_t *device, unsigned int command, const unsigned char data[], unsigned int size)
+{
+	unsigned char buffer[4 + 2 * 4 + 2];
+	unsigned int n = 0;
+
+	// Without COM port control, the remote serial port has a fixed
+	// configuration, and all requests are ignored.
+	if (device->protocol != DC_TCP_RFC2217)
+		return DC_STATUS_SUCCESS;
+
+	if (size > 4)
+		return DC_STATUS_INVALIDARGS;
+
+	buffer[n++] = IAC;
+	buffer[n++] = SB;
+	buffer[n++] = OPT_COMPORT;
+	buffer[n++] = command;
+	for (unsigned int i = 0; i < size; ++i) {
+		if (data[i] == IAC)
+			buffer[n++] = IAC;
+		buffer[n++] = data[i];
+	}
+	buffer[n++] = IAC;
+	buffer[n++] = SE;
+
+	return dc_socket_write ((dc_iostream_t *) device, buffer, n, NULL);
+}
+
+static dc_status_t
+dc_tcp_control (dc_tcp_t *device, unsigned int value)
+{
+	unsigned char data[1] = {value};
+
+	return dc_tcp_comport (device, SET_CONTROL, data, sizeof (data));
+}
+
+static void
+dc_tcp_negotiate (dc_tcp_t *device, unsigned int command, unsigned int option)
+{
+	dc_context_t *context = device->base.base.context;
+	unsigned int reply = 0;
+
+	switch (command) {
+	case DO:
+		// Acknowledgement of an option we requested.
+		if (option == OPT_BINARY || option == OPT_SGA || option == OPT_COMPORT)
+			return;
+		reply = WONT;
+		break;
+	case WILL:
+		// Acknowledgement of an option we requested.
+		if (option == OPT_BINARY || option == OPT_SGA)
+			return;
+		reply = DONT;
+		break;
+	default:
+		if (command == DONT && option == OPT_COMPORT) {
+			WARNING (context, "The remote side refused the COM port control option.");
+		}
+		return;
+	}
+
+	const unsigned char data[] = {IAC, reply, option};
+	dc_socket_write ((dc_iostream_t *) device, data, sizeof (data), NULL);
+}
+
+/*
+ * Remove the telnet commands from the received data, and process them.
+ * Returns the number of data bytes, which are moved to the start of the
+ * buffer. The state is preserved, because commands can be split over
+ * multiple reads.
+ */
+static size_t
+dc_tcp_filter (dc_tcp_t *device, unsigned char data[], size_t size)
+{
+	size_t n = 0;
+
+	for (size_t i = 0; i < size; ++i) {
+		unsigned char c = data[i];
+		switch (device->state) {
+		case STATE_DATA:
+			if (c == IAC) {
+				device->state = STATE_IAC;
+			} else {
+				data[n++] = c;
+			}
+			break;
+		case STATE_IAC:
+			if (c == IAC) {
+				// Escaped data byte.
+				data[n++] = c;
+				device->state = STATE_DATA;
+			} else if (c >= WILL) {
+				device->command = c;
+				device->state = STATE_OPTION;
+			} else if (c == SB) {
+				device->state = STATE_SB;
+			} else {
+				// Other commands are ignored.
+				device->state = STATE_DATA;
+			}
+			break;
+		case STATE_OPTION:
+			dc_tcp_negotiate (device, device->command, c);
+			device->state = STATE_DATA;
+			break;
+		case STATE_SB:
+			// The replies to the COM port control commands are ignored.
+			if (c == IAC)
+				device->state = STATE_SB_IAC;
+			break;
+		case STATE_SB_IAC:
+			device->state = (c == SE) ? STATE_DATA : STATE_SB;
+			break;
+		}
+	}
+
+	return n;
+}
+
+/*
+ * Decode the data that is pending on the socket, without blocking, and
+ * append the data bytes to the receive buffer. Returns the number of
+ * bytes received from the socket, including the telnet commands.
+ */
+static dc_status_t
+dc_tcp_decode (dc_tcp_t *device, size_t *received)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_iostream_t *abstract = (dc_iostream_t *) device;
+
+	// Move the remaining data to the start of the buffer.
+	if (device->offset) {
+		memmove (device->buffer, device->buffer + device->offset, device->available);
+		device->offset = 0;
+	}
+
+	size_t pending = 0;
+	status = dc_socket_get_available (abstract, &pending);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	size_t len = sizeof (device->buffer) - device->available;
+	if (len > pending)
+		len = pending;
+
+	size_t n = 0;
+	if (len) {
+		unsigned char *p = device->buffer + device->available;
+		status = dc_socket_read (abstract, p, len, &n);
+		device->available += dc_tcp_filter (device, p, n);
+	}
+
+	if (received)
+		*received = n;
+
+	return status;
+}
+
+dc_status_t
+dc_tcp_open (dc_iostream_t **out, dc_context_t *context, const char *hostname, unsigned int port, dc_tcp_protocol_t protocol)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_tcp_t *device = NULL;
+	struct addrinfo hints, *result = NULL;
+	char service[16];
+
+	if (out == NULL || hostname == NULL || port == 0 || port > 65535 ||
+		(protocol != DC_TCP_RAW && protocol != DC_TCP_RFC2217))
+		return DC_STATUS_INVALIDARGS;
+
+	INFO (context, "Open: hostname=%s, port=%u, protocol=%s", hostname, port,
+		protocol == DC_TCP_RFC2217 ? "rfc2217" : "raw");
+
+	// Allocate memory.
+	device = (dc_tcp_t *) dc_iostream_allocate (context, &dc_tcp_vtable, DC_TRANSPORT_SERIAL);
+	if (device == NULL) {
+		SYSERROR (context, S_ENOMEM);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	device->protocol = protocol;
+	device->state = STATE_DATA;
+	device->command = 0;
+	device->timer = NULL;
+	device->offset = 0;
+	device->available = 0;
+
+	// Create a high resolution timer.
+	status = dc_timer_new (&device->timer);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to create a high resolution timer.");
+		goto error_free;
+	}
+
+	// Initialize the socket library.
+	status = dc_socket_init (context);
+	if (status != DC_STATUS_SUCCESS) {
+		goto error_timer_free;
+	}
+
+	// Resolve the hostname.
+	memset (&hints, 0, sizeof (hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	snprintf (service, sizeof (service), "%u", port);
+	int rc = getaddrinfo (hostname, service, &hints, &result);
+	if (rc != 0) {
+		ERROR (context, "Failed to resolve the hostname '%s' (%s).", hostname, gai_strerror (rc));
+		status = DC_STATUS_NODEVICE;
+		goto error_exit;
+	}
+
+	// Connect to the first address that accepts the connection.
+	status = DC_STATUS_NODEVICE;
+	for (struct addrinfo *ai = result; ai != NULL; ai = ai->ai_next) {
+		status = dc_socket_open ((dc_iostream_t *) device, ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (status != DC_STATUS_SUCCESS)
+			continue;
+
+		status = dc_socket_connect ((dc_iostream_t *) device, ai->ai_addr, ai->ai_addrlen);
+		if (status == DC_STATUS_SUCCESS)
+			break;
+
+		dc_socket_close ((dc_iostream_t *) device);
+	}
+	freeaddrinfo (result);
+	if (status != DC_STATUS_SUCCESS) {
+		goto error_exit;
+	}
+
+	// Send the small packets immediately.
+	int optval = 1;
+	if (setsockopt (device->base.fd, IPPROTO_TCP, TCP_NODELAY, (const char *) &optval, sizeof (optval)) != 0) {
+		s_errcode_t errcode = S_ERRNO;
+		SYSERROR (context, errcode);
+	}
+
+	if (protocol == DC_TCP_RFC2217) {
+		// Request a transparent 8-bit data path, and offer the COM port
+		// control option.
+		static const unsigned char negotiate[] = {
+			IAC, WILL, OPT_BINARY,
+			IAC, DO, OPT_BINARY,
+			IAC, WILL, OPT_SGA,
+			IAC, DO, OPT_SGA,
+			IAC, WILL, OPT_COMPORT,
+		};
+		status = dc_socket_write ((dc_iostream_t *) device, negotiate, sizeof (negotiate), NULL);
+		if (status != DC_STATUS_SUCCESS) {
+			goto error_close;
+		}
+	}
+
+	// The open socket holds its own reference to the socket library.
+	dc_socket_exit (context);
+
+	*out = (dc_iostream_t *) device;
+
+	return DC_STATUS_SUCCESS;
+
+error_close:
+	dc_socket_close ((dc_iostream_t *) device);
+error_exit:
+	dc_socket_exit (context);
+error_timer_free:
+	dc_timer_free (device->timer);
+error_free:
+	dc_iostream_deallocate ((dc_iostream_t *) device);
+	return status;
+}
+
+static dc_status_t
+dc_tcp_close (dc_iostream_t *abstract)
+{
+	dc_tcp_t *device = (dc_tcp_t *) abstract;
+
+	dc_timer_free (device->timer);
+
+	return dc_socket_close (abstract);
+}
+
+static dc_status_t
+dc_tcp_set_break (dc_iostream_t *abstract, unsigned int value)
+{
+	return dc_tcp_control ((dc_tcp_t *) abstract, value ? CONTROL_BREAK_ON : CONTROL_BREAK_OFF);
+}
+
+static dc_status_t
+dc_tcp_set_dtr (dc_iostream_t *abstract, unsigned int value)
+{
+	return dc_tcp_control ((dc_tcp_t *) abstract, value ? CONTROL_DTR_ON : CONTROL_DTR_OFF);
+}
+
+static dc_status_t
+dc_tcp_set_rts (dc_iostream_t *abstract, unsigned int value)
+{
+	return dc_tcp_control ((dc_tcp_t *) abstract, value ? CONTROL_RTS_ON : CONTROL_RTS_OFF);
+}
+
+static dc_status_t
+dc_tcp_get_available (dc_iostream_t *abstract, size_t *value)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_tcp_t *device = (dc_tcp_t *) abstract;
+
+	if (device->protocol != DC_TCP_RFC2217)
+		return dc_socket_get_available (abstract, value);
+
+	// Only the decoded data bytes are reported, because the telnet
+	// commands are removed by the read.
+	status = dc_tcp_decode (device, NULL);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	if (value)
+		*value = device->available;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_tcp_configure (dc_iostream_t *abstract, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_tcp_t *device = (dc_tcp_t *) abstract;
+
+	// Set the baudrate.
+	unsigned char rate[4];
+	array_uint32_be_set (rate, baudrate);
+
+	// Set the character size.
+	if (databits < 5 || databits > 8)
+		return DC_STATUS_INVALIDARGS;
+	unsigned char size[1] = {databits};
+
+	// Set the parity type.
+	unsigned char mode[1] = {0};
+	switch (parity) {
+	case DC_PARITY_NONE:
+		mode[0] = 1;
+		break;
+	case DC_PARITY_ODD:
+		mode[0] = 2;
+		break;
+	case DC_PARITY_EVEN:
+		mode[0] = 3;
+		break;
+	case DC_PARITY_MARK:
+		mode[0] = 4;
+		break;
+	case DC_PARITY_SPACE:
+		mode[0] = 5;
+		break;
+	default:
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	// Set the number of stop bits.
+	unsigned char stop[1] = {0};
+	switch (stopbits) {
+	case DC_STOPBITS_ONE:
+		stop[0] = 1;
+		break;
+	case DC_STOPBITS_TWO:
+		stop[0] = 2;
+		break;
+	case DC_STOPBITS_ONEPOINTFIVE:
+		stop[0] = 3;
+		break;
+	default:
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	// Set the flow control.
+	unsigned int control = 0;
+	switch (flowcontrol) {
+	case DC_FLOWCONTROL_NONE:
+		control = CONTROL_FLOW_NONE;
+		break;
+	case DC_FLOWCONTROL_HARDWARE:
+		control = CONTROL_FLOW_HARDWARE;
+		break;
+	case DC_FLOWCONTROL_SOFTWARE:
+		control = CONTROL_FLOW_XONXOFF;
+		break;
+	default:
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	status = dc_tcp_comport (device, SET_BAUDRATE, rate, sizeof (rate));
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	status = dc_tcp_comport (device, SET_DATASIZE, size, sizeof (size));
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	status = dc_tcp_comport (device, SET_PARITY, mode, sizeof (mode));
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	status = dc_tcp_comport (device, SET_STOPSIZE, stop, sizeof (stop));
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_tcp_control (device, control);
+}
+
+/*
+ * Convert a timeout (in milliseconds) into a target time, or calculate
+ * the remaining timeout until the target time. A negative or zero
+ * timeout is left unchanged.
+ */
+static dc_status_t
+dc_tcp_deadline (dc_tcp_t *device, int timeout, dc_usecs_t *target, int *remaining)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (timeout <= 0) {
+		if (remaining)
+			*remaining = timeout;
+		return DC_STATUS_SUCCESS;
+	}
+
+	dc_usecs_t now = 0;
+	status = dc_timer_now (device->timer, &now);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	if (remaining == NULL) {
+		// Calculate the target time.
+		*target = now + (dc_usecs_t) timeout * 1000;
+	} else if (now < *target) {
+		// Calculate the remaining timeout.
+		*remaining = (*target - now + 999) / 1000;
+	} else {
+		*remaining = 0;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_tcp_poll (dc_iostream_t *abstract, int timeout)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_tcp_t *device = (dc_tcp_t *) abstract;
+	dc_usecs_t target = 0;
+
+	if (device->protocol != DC_TCP_RFC2217)
+		return dc_socket_poll (abstract, timeout);
+
+	status = dc_tcp_deadline (device, timeout, &target, NULL);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	// Wait until data bytes are available. Telnet commands alone don't
+	// count, and the wait continues for the remaining time.
+	while (device->available == 0) {
+		int remaining = 0;
+		status = dc_tcp_deadline (device, timeout, &target, &remaining);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+
+		status = dc_socket_poll (abstract, remaining);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+
+		size_t received = 0;
+		status = dc_tcp_decode (device, &received);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+
+		// The socket is readable without any pending data once the
+		// connection is closed. This is reported by the next read.
+		if (received == 0)
+			break;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_tcp_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_tcp_t *device = (dc_tcp_t *) abstract;
+	unsigned char *p = (unsigned char *) data;
+	size_t nbytes = 0;
+
+	if (device->protocol != DC_TCP_RFC2217)
+		return dc_socket_read (abstract, data, size, actual);
+
+	// The timeout applies to the read as a whole, no matter how many
+	// telnet commands arrive in between the data bytes.
+	int timeout = device->base.timeout;
+	dc_usecs_t target = 0;
+	status = dc_tcp_deadline (device, timeout, &target, NULL);
+	if (status != DC_STATUS_SUCCESS)
+		goto out;
+
+	while (nbytes < size) {
+		// Return the data that is already decoded.
+		if (device->available) {
+			size_t len = size - nbytes;
+			if (len > device->available)
+				len = device->available;
+			memcpy (p + nbytes, device->buffer + device->offset, len);
+			device->offset += len;
+			device->available -= len;
+			nbytes += len;
+			continue;
+		}
+
+		// Wait for more data bytes, within the remaining time.
+		int remaining = 0;
+		status = dc_tcp_deadline (device, timeout, &target, &remaining);
+		if (status != DC_STATUS_SUCCESS)
+			break;
+
+		status = dc_tcp_poll (abstract, remaining);
+		if (status != DC_STATUS_SUCCESS)
+			break;
+
+		// No data bytes after the wait means the connection is closed.
+		if (device->available == 0) {
+			status = DC_STATUS_TIMEOUT;
+			break;
+		}
+	}
+
+out:
+	if (actual)
+		*actual = nbytes;
+
+	return status;
+}
+
+static dc_status_t
+dc_tcp_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_tcp_t *device = (dc_tcp_t *) abstract;
+	const unsigned char *p = (const unsigned char *) data;
+	unsigned char buffer[2 * SZ_BUFFER];
+	size_t nbytes = 0;
+
+	if (device->protocol != DC_TCP_RFC2217)
+		return dc_socket_write (abstract, data, size, actual);
+
+	while (nbytes < size) {
+		size_t len = size - nbytes;
+		if (len > SZ_BUFFER)
+			len = SZ_BUFFER;
+
+		// Escape the IAC bytes.
+		size_t n = 0;
+		for (size_t i = 0; i < len; ++i) {
+			if (p[nbytes + i] == IAC)
+				buffer[n++] = IAC;
+			buffer[n++] = p[nbytes + i];
+		}
+
+		status = dc_socket_write (abstract, buffer, n, NULL);
+		if (status != DC_STATUS_SUCCESS)
+			break;
+
+		nbytes += len;
+	}
+
+	if (actual)
+		*actual = nbytes;
+
+	return status;
+}
+
+static dc_status_t
+dc_tcp_purge (dc_iostream_t *abstract, dc_direction_t direction)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_tcp_t *device = (dc_tcp_t *) abstract;
+
+	unsigned char value[1] = {0};
+	switch (direction) {
+	case DC_DIRECTION_INPUT:
+		value[0] = PURGE_RX;
+		break;
+	case DC_DIRECTION_OUTPUT:
+		value[0] = PURGE_TX;
+		break;
+	case DC_DIRECTION_ALL:
+		value[0] = PURGE_BOTH;
+		break;
+	default:
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	// Purge the buffers of the remote serial port.
+	status = dc_tcp_comport (device, PURGE_DATA, value, sizeof (value));
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	// Discard the data that already arrived locally.
+	if (direction & DC_DIRECTION_INPUT) {
+		device->offset = 0;
+		device->available = 0;
+
+		unsigned char buffer[SZ_BUFFER];
+		size_t available = 0;
+		while ((status = dc_socket_get_available (abstract, &available)) == DC_STATUS_SUCCESS && available) {
+			size_t len = available < sizeof (buffer) ? available : sizeof (buffer);
+			size_t n = 0;
+			status = dc_socket_read (abstract, buffer, len, &n);
+			if (device->protocol == DC_TCP_RFC2217) {
+				dc_tcp_filter (device, buffer, n);
+			}
+			if (status != DC_STATUS_SUCCESS)
+				break;
+		}
+	}
+
+	return status;
+}
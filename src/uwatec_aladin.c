@@ -32,6 +32,7 @@
 #define ISINSTANCE(device) dc_device_isinstance((device), &uwatec_aladin_device_vtable)
 
 #define SZ_MEMORY 2048
+#define SZ_PACKET 128
 
 #define RB_PROFILE_BEGIN			0x000
 #define RB_PROFILE_END				0x600
@@ -150,8 +151,8 @@ uwatec_aladin_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	dc_status_t status = DC_STATUS_SUCCESS;
 	uwatec_aladin_device_t *device = (uwatec_aladin_device_t*) abstract;
 
-	// Pre-allocate the required amount of memory.
-	if (!dc_buffer_reserve (buffer, SZ_MEMORY)) {
+	// Allocate the required amount of memory.
+	if (!dc_buffer_resize (buffer, SZ_MEMORY)) {
 		ERROR (abstract->context, "Insufficient buffer space available.");
 		return DC_STATUS_NOMEMORY;
 	}
@@ -161,7 +162,7 @@ uwatec_aladin_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	progress.maximum = SZ_MEMORY + 2;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	unsigned char answer[SZ_MEMORY + 2] = {0};
+	unsigned char *answer = dc_buffer_get_data (buffer);
 
 	// Receive the header of the package.
 	unsigned int i = 0;
@@ -192,23 +193,49 @@ uwatec_aladin_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	progress.current += 4;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	// Receive the remaining part of the package.
-	status = dc_iostream_read (device->iostream, answer + 4, sizeof (answer) - 4, NULL);
+	// Reverse the bit order of the header.
+	array_reverse_bits (answer, 4);
+	unsigned short ccrc = checksum_add_uint16 (answer, 4, 0x0000);
+
+	// Receive the remaining part of the package. The bit order is reversed
+	// and the checksum is updated for each chunk as soon as it arrives.
+	unsigned int nbytes = 4;
+	while (nbytes < SZ_MEMORY) {
+		unsigned int len = SZ_MEMORY - nbytes;
+		if (len > SZ_PACKET)
+			len = SZ_PACKET;
+
+		status = dc_iostream_read (device->iostream, answer + nbytes, len, NULL);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Unexpected EOF in answer.");
+			return status;
+		}
+
+		array_reverse_bits (answer + nbytes, len);
+		ccrc = checksum_add_uint16 (answer + nbytes, len, ccrc);
+
+		// Update and emit a progress event.
+		progress.current += len;
+		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+		nbytes += len;
+	}
+
+	// Receive the checksum.
+	unsigned char checksum[2] = {0};
+	status = dc_iostream_read (device->iostream, checksum, sizeof (checksum), NULL);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Unexpected EOF in answer.");
 		return status;
 	}
 
 	// Update and emit a progress event.
-	progress.current += sizeof (answer) - 4;
+	progress.current += sizeof (checksum);
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	// Reverse the bit order.
-	array_reverse_bits (answer, sizeof (answer));
-
 	// Verify the checksum of the package.
-	unsigned short crc = array_uint16_le (answer + SZ_MEMORY);
-	unsigned short ccrc = checksum_add_uint16 (answer, SZ_MEMORY, 0x0000);
+	array_reverse_bits (checksum, sizeof (checksum));
+	unsigned short crc = array_uint16_le (checksum);
 	if (ccrc != crc) {
 		ERROR (abstract->context, "Unexpected answer checksum.");
 		return DC_STATUS_PROTOCOL;
@@ -224,8 +251,6 @@ uwatec_aladin_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	clock.devtime = device->devtime;
 	device_event_emit (abstract, DC_EVENT_CLOCK, &clock);
 
-	dc_buffer_append (buffer, answer, SZ_MEMORY);
-
 	return DC_STATUS_SUCCESS;
 }
 